@@ -0,0 +1,29 @@
+// *****
+// * PROJECT:		DESLib (DES)
+// * FILENAME: 		PalmOS.h
+// *
+// * DESCRIPTION:	Host stand-in for the Palm OS SDK header, just enough for
+// *				DESLibPrv.c to build for the benchmark.  The Palm build
+// *				uses the real one.
+// *
+// *****
+#ifndef BENCH_PALMOS_H
+#define BENCH_PALMOS_H
+
+#include <string.h>
+#include <stdint.h>
+
+typedef uint32_t	UInt32;
+typedef uint16_t	UInt16;
+typedef int16_t		Int16;
+typedef uint8_t		UInt8;
+typedef uint16_t	Err;
+
+#define SYS_TRAP(trapNum)
+#define sysLibTrapCustom	4
+
+#define MemMove(dst, src, n)	memmove((dst), (src), (n))
+#define MemSet(p, n, value)		memset((p), (value), (n))
+#define MemCmp(a, b, n)			memcmp((a), (b), (n))
+
+#endif
@@ -0,0 +1,33 @@
+// *****
+// * PROJECT:		DESLib (DES)
+// * FILENAME: 		baseline.h
+// *
+// * DESCRIPTION:	Host throughput benchmark: forced into the baseline build
+// *				so that its external names do not collide with the current
+// *				library's in the one benchmark program.
+// *
+// *****
+#define DES_Init				Baseline_DES_Init
+#define DES_Restart				Baseline_DES_Restart
+#define DES_ECBUpdate			Baseline_DES_ECBUpdate
+#define DES_CBCUpdate			Baseline_DES_CBCUpdate
+#define DES_CFBUpdate			Baseline_DES_CFBUpdate
+#define DES_OFBISOUpdate		Baseline_DES_OFBISOUpdate
+#define DES_OFBFIPS81Update		Baseline_DES_OFBFIPS81Update
+#define DESX_Init				Baseline_DESX_Init
+#define DESX_Restart			Baseline_DESX_Restart
+#define DESX_ECBUpdate			Baseline_DESX_ECBUpdate
+#define DESX_CBCUpdate			Baseline_DESX_CBCUpdate
+#define DESX_CFBUpdate			Baseline_DESX_CFBUpdate
+#define DESX_OFBISOUpdate		Baseline_DESX_OFBISOUpdate
+#define DESX_OFBFIPS81Update	Baseline_DESX_OFBFIPS81Update
+#define DES3_Init				Baseline_DES3_Init
+#define DES3_Restart			Baseline_DES3_Restart
+#define DES3_ECBUpdate			Baseline_DES3_ECBUpdate
+#define DES3_CBCUpdate			Baseline_DES3_CBCUpdate
+#define DES3_CFBUpdate			Baseline_DES3_CFBUpdate
+#define DES3_OFBISOUpdate		Baseline_DES3_OFBISOUpdate
+#define DES3_OFBFIPS81Update	Baseline_DES3_OFBFIPS81Update
+#define Initialize_DES			Baseline_Initialize_DES
+#define Encrypt_DES				Baseline_Encrypt_DES
+#define Decrypt_DES				Baseline_Decrypt_DES
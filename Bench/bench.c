@@ -0,0 +1,67 @@
+// *****
+// * PROJECT:		DESLib (DES)
+// * FILENAME: 		bench.c
+// *
+// * DESCRIPTION:	Host throughput benchmark.  Prints MB/s for every type,
+// *				mode and direction, from the baseline release and from
+// *				the current library with each of its kernels, so a
+// *				table or kernel change can be judged on the CPU at hand.
+// *				The Palm build does not use it; see the Makefile.
+// *
+// *				usage: bench [seconds per figure]
+// *
+// *****
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench.h"
+
+// Constants shared by both releases; CTR is the current library's only.
+#define DES  	1
+#define DESX 	2
+#define DES3 	3
+#define ECB			1
+#define CBC			2
+#define CFB			3
+#define OFBISO		4
+#define OFBFIPS81	5
+#define CTR			6
+#define ENCRYPT 1
+#define DECRYPT 0
+
+#define BENCH_SECONDS	0.2
+
+static const char *typeNames[] = { "", "DES", "DESX", "DES3" };
+static const char *modeNames[] = { "", "ECB", "CBC", "CFB", "OFBISO", "OFBFIPS81", "CTR" };
+
+static void PrintRate(double rate)
+{
+	if (rate < 0)
+		printf(" %10s", "-");
+	else
+		printf(" %10.2f", rate);
+}
+
+int main(int argc, char **argv)
+{
+	double seconds;
+	int destype, desmode, encrypt, kernel;
+
+	seconds = (argc > 1) ? atof(argv[1]) : BENCH_SECONDS;
+	if (seconds <= 0)
+		seconds = BENCH_SECONDS;
+
+	printf("MB/s, %d-byte calls, 64-bit CFB and OFB segments, %.2f s a figure\n", BENCH_BYTES, seconds);
+	printf("%-5s %-10s %-8s %10s %10s %10s %10s %10s\n",
+		"type", "mode", "dir", "baseline", "tables", "bigsp", "bitslice", "consttime");
+	for (destype = DES; destype <= DES3; destype++)
+		for (desmode = ECB; desmode <= CTR; desmode++)
+			for (encrypt = ENCRYPT; encrypt >= DECRYPT; encrypt--) {
+				printf("%-5s %-10s %-8s", typeNames[destype], modeNames[desmode], encrypt ? "encrypt" : "decrypt");
+				PrintRate(BaselineRate(destype, desmode, encrypt, BENCH_TABLES, seconds));
+				for (kernel = 0; kernel < BENCH_KERNELS; kernel++)
+					PrintRate(CurrentRate(destype, desmode, encrypt, kernel, seconds));
+				printf("\n");
+				fflush(stdout);
+			}
+	return 0;
+}
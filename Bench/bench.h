@@ -0,0 +1,27 @@
+// *****
+// * PROJECT:		DESLib (DES)
+// * FILENAME: 		bench.h
+// *
+// * DESCRIPTION:	Host throughput benchmark: what bench.c asks of the two
+// *				builds of rate.c.
+// *
+// *****
+#ifndef BENCH_H
+#define BENCH_H
+
+// Kernels timed for every type, mode and direction.
+#define BENCH_TABLES		0		//classic SP tables throughout
+#define BENCH_BIGSP			1		//merged 4 x 4096 SP tables for single blocks and DES3
+#define BENCH_BITSLICE		2		//classic tables for single blocks, bitsliced runs of blocks
+#define BENCH_CONSTTIME		3		//DES_OPT_CONSTTIME from initialization on
+#define BENCH_KERNELS		4
+
+#define BENCH_BYTES			16384	//bytes per Encrypt_DES or Decrypt_DES call
+
+// MB/s for seconds of calls, or a negative figure where the build has
+// no such type, mode or kernel.  BaselineRate times the release the
+// table and kernel work started from and takes BENCH_TABLES only.
+double BaselineRate(int destype, int desmode, int encrypt, int kernel, double seconds);
+double CurrentRate(int destype, int desmode, int encrypt, int kernel, double seconds);
+
+#endif
@@ -0,0 +1,77 @@
+// *****
+// * PROJECT:		DESLib (DES)
+// * FILENAME: 		rate.c
+// *
+// * DESCRIPTION:	Host throughput benchmark: one figure from one build of
+// *				the library.  The Makefile compiles this file twice, once
+// *				against ../Src and once, with BENCH_BASELINE, against the
+// *				baseline sources it takes out of git, so each copy sees
+// *				its own DES_CTX.
+// *
+// *****
+#include <time.h>
+#include <PalmOS.h>
+#include "DESLib.h"
+#include "DESLibPrv.h"
+#include "bench.h"
+
+#ifdef BENCH_BASELINE
+#define BENCH_RATE	BaselineRate
+#else
+#define BENCH_RATE	CurrentRate
+#endif
+
+static unsigned char key[24] = {
+	0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef,
+	0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef, 0x01,
+	0x45, 0x67, 0x89, 0xab, 0xcd, 0xef, 0x01, 0x23
+};
+static unsigned char iv[8] = { 0x12, 0x34, 0x56, 0x78, 0x90, 0xab, 0xcd, 0xef };
+static unsigned char input[BENCH_BYTES], output[BENCH_BYTES];
+
+double BENCH_RATE(int destype, int desmode, int encrypt, int kernel, double seconds)
+{
+	DES_CTX context;
+	clock_t start, elapsed;
+	unsigned long bytes;
+	int i;
+
+	MemSet(&context, sizeof(context), 0);
+#ifdef BENCH_BASELINE
+	if ((desmode > OFBFIPS81) || (kernel != BENCH_TABLES))
+		return -1;
+	Initialize_DES(key, iv, desmode, destype, encrypt, &context);
+#else
+	if (Initialize_DESOptions(key, iv, desmode, destype, encrypt, (kernel == BENCH_CONSTTIME) ? DES_OPT_CONSTTIME : 0, &context))
+		return -1;
+	for (i = 0; i < DES_CLASSES; i++)
+		context.kernel[i] = DES_KERNEL_SCALAR;
+	if (kernel == BENCH_BIGSP) {
+		if (!DESKernelValid(DES_CLASS_SINGLE, DES_KERNEL_BIGSP))
+			return -1;
+		context.kernel[DES_CLASS_SINGLE] = DES_KERNEL_BIGSP;
+		context.kernel[DES_CLASS_DES3] = DES_KERNEL_BIGSP;
+	}
+	if (kernel == BENCH_BITSLICE) {
+		if (!DESKernelValid(DES_CLASS_MULTI, DES_KERNEL_BITSLICE))
+			return -1;
+		context.kernel[DES_CLASS_MULTI] = DES_KERNEL_BITSLICE;
+	}
+#endif
+	// Whole-block segments, which both releases handle, for CFB and OFB.
+	context.n = 64;
+
+	for (i = 0; i < BENCH_BYTES; i++)
+		input[i] = (unsigned char)i;
+	bytes = 0;
+	start = clock();
+	do {
+		if (encrypt)
+			Encrypt_DES(&context, input, output, BENCH_BYTES);
+		else
+			Decrypt_DES(&context, input, output, BENCH_BYTES);
+		bytes += BENCH_BYTES;
+		elapsed = clock() - start;
+	} while (elapsed < (clock_t)(seconds * CLOCKS_PER_SEC));
+	return (double)bytes / ((double)elapsed / CLOCKS_PER_SEC) / 1e6;
+}
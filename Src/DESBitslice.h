@@ -0,0 +1,725 @@
+// *****
+// * PROJECT:		DESLib (DES)
+// * FILENAME: 		DESBitslice.h
+// * AUTHOR:		Hector Ho Fuentes
+// *
+// * DESCRIPTION:	Gate-level S-box circuits for the bitsliced DES engine in
+// *				DESLibPrv.c.  Each DES_BS_WORD carries one bit of
+// *				DES_BS_LANES independent blocks, so one pass through these
+// *				functions evaluates an S-box for every lane at once without
+// *				a single table lookup.
+// *
+// *				DESBitsliceSn takes the six bits DESFunction would use to
+// *				index SPn (a0 is the least significant) and xors its four
+// *				outputs straight into the destination half, at the bit
+// *				positions where SPn would have set them.  The circuits were
+// *				derived from SP1..SP8 in DESTables.h and checked against
+// *				them for all 64 inputs.
+// *
+// * HISTORY:		Hector Ho Fuentes 4/4/2001
+// *
+// *
+// * COPYRIGHT:		
+// *
+// *****
+
+#ifndef _DESBITSLICE_H_
+#define _DESBITSLICE_H_ 1
+
+// One bit-plane: bit i holds the state of block i.  A batch is as many
+// blocks as the plane word has bits.  The 68K build keeps 32-bit planes;
+// hosts with 64-bit registers get 64-lane batches at the same gate count
+// per plane, i.e. half the work per block.  Define DES_BITSLICE_WIDE or
+// DES_BITSLICE_NARROW to override the choice.
+#if !defined(DES_BITSLICE_WIDE) && !defined(DES_BITSLICE_NARROW)
+#if defined(__LP64__) || defined(_WIN64) || defined(__x86_64__) || defined(__aarch64__)
+#define DES_BITSLICE_WIDE
+#endif
+#endif
+
+#ifdef DES_BITSLICE_WIDE
+typedef unsigned long long DES_BS_WORD;
+
+#define DES_BS_LANES	64				// Blocks per bitsliced batch
+#else
+typedef UInt32 DES_BS_WORD;
+
+#define DES_BS_LANES	32				// Blocks per bitsliced batch
+#endif
+
+static void DESBitsliceS1 (DES_BS_WORD *out, DES_BS_WORD a0, DES_BS_WORD a1,
+  DES_BS_WORD a2, DES_BS_WORD a3, DES_BS_WORD a4, DES_BS_WORD a5)
+{
+  DES_BS_WORD t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13,
+    t14, t15, t16, t17, t18, t19, t20, t21, t22, t23, t24, t25, t26, t27,
+    t28, t29, t30, t31, t32, t33, t34, t35, t36, t37, t38, t39, t40, t41,
+    t42, t43, t44, t45, t46, t47, t48, t49, t50, t51, t52, t53, t54, t55,
+    t56, t57, t58, t59, t60, t61, t62, t63, t64, t65, t66, t67, t68, t69,
+    t70, t71, t72, t73, t74, t75, t76;
+
+  t0 = ~a5;
+  t1 = a4 ^ t0;
+  t2 = a4 | t0;
+  t3 = a1 & t2;
+  t4 = a0 & t3;
+  t5 = t1 ^ t4;
+  t6 = a4 | a5;
+  t7 = a0 & t6;
+  t8 = a1 | t7;
+  t9 = a3 & t8;
+  t10 = t5 ^ t9;
+  t11 = t6 & ~a1;
+  t12 = t2 ^ t11;
+  t13 = a1 ^ a4;
+  t14 = t13 | ~a3;
+  t15 = a5 & t14;
+  t16 = a4 ^ t15;
+  t17 = t16 & ~a0;
+  t18 = t12 ^ t17;
+  t19 = t18 & ~a2;
+  t20 = t10 ^ t19;
+  t21 = ~t1;
+  t22 = a2 ^ a5;
+  t23 = t22 | ~a4;
+  t24 = a3 & t23;
+  t25 = t21 ^ t24;
+  t26 = t2 & ~a3;
+  t27 = t26 | ~a2;
+  t28 = t27 & ~a0;
+  t29 = t25 ^ t28;
+  t30 = a0 & a4;
+  t31 = t30 | ~a5;
+  t32 = a3 | t31;
+  t33 = t0 & ~a3;
+  t34 = t2 ^ t33;
+  t35 = a0 ^ t34;
+  t36 = a2 & t35;
+  t37 = t32 ^ t36;
+  t38 = a1 & t37;
+  t39 = t29 ^ t38;
+  t40 = a2 | t2;
+  t41 = a3 & t40;
+  t42 = t23 ^ t41;
+  t43 = a2 & t0;
+  t44 = t1 ^ t43;
+  t45 = a3 & t44;
+  t46 = t22 ^ t45;
+  t47 = (a0 & t46) | (t42 & ~a0);
+  t48 = a3 ^ a4;
+  t49 = t0 | ~a4;
+  t50 = a3 | t49;
+  t51 = t50 & ~a0;
+  t52 = t48 ^ t51;
+  t53 = a0 & t34;
+  t54 = t1 ^ t53;
+  t55 = t54 & ~a2;
+  t56 = t52 ^ t55;
+  t57 = a1 & t56;
+  t58 = t47 ^ t57;
+  t59 = t0 | ~a2;
+  t60 = t59 & ~a3;
+  t61 = t44 ^ t60;
+  t62 = a5 | ~a4;
+  t63 = t62 & ~a3;
+  t64 = a2 | t63;
+  t65 = t64 & ~a0;
+  t66 = t61 ^ t65;
+  t67 = ~t23;
+  t68 = a2 ^ t1;
+  t69 = a0 & t68;
+  t70 = t67 ^ t69;
+  t71 = a5 | ~a2;
+  t72 = t71 & ~a0;
+  t73 = a4 | t72;
+  t74 = a3 & t73;
+  t75 = t70 ^ t74;
+  t76 = (a1 & t75) | (t66 & ~a1);
+
+  out[2] ^= t20;
+  out[10] ^= t76;
+  out[16] ^= t58;
+  out[24] ^= t39;
+}
+
+static void DESBitsliceS2 (DES_BS_WORD *out, DES_BS_WORD a0, DES_BS_WORD a1,
+  DES_BS_WORD a2, DES_BS_WORD a3, DES_BS_WORD a4, DES_BS_WORD a5)
+{
+  DES_BS_WORD t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13,
+    t14, t15, t16, t17, t18, t19, t20, t21, t22, t23, t24, t25, t26, t27,
+    t28, t29, t30, t31, t32, t33, t34, t35, t36, t37, t38, t39, t40, t41,
+    t42, t43, t44, t45, t46, t47, t48, t49, t50, t51, t52, t53, t54, t55,
+    t56, t57, t58, t59, t60, t61, t62, t63, t64;
+
+  t0 = a4 | a5;
+  t1 = a3 ^ t0;
+  t2 = a5 | ~a4;
+  t3 = a3 | t2;
+  t4 = t3 & ~a0;
+  t5 = t1 ^ t4;
+  t6 = a3 ^ a4;
+  t7 = t6 | ~a5;
+  t8 = t7 | ~a0;
+  t9 = a1 & t8;
+  t10 = t5 ^ t9;
+  t11 = a0 | ~a5;
+  t12 = a1 & t11;
+  t13 = a4 | t12;
+  t14 = a2 & t13;
+  t15 = t10 ^ t14;
+  t16 = a5 ^ t6;
+  t17 = a4 & ~a3;
+  t18 = t17 | ~a5;
+  t19 = a2 & t18;
+  t20 = t16 ^ t19;
+  t21 = a2 & a3;
+  t22 = t17 ^ t21;
+  t23 = a5 | t22;
+  t24 = a0 & t23;
+  t25 = t20 ^ t24;
+  t26 = a0 | t18;
+  t27 = a0 & a4;
+  t28 = a3 ^ t27;
+  t29 = a5 | t28;
+  t30 = t29 & ~a2;
+  t31 = t26 ^ t30;
+  t32 = t31 & ~a1;
+  t33 = t25 ^ t32;
+  t34 = a2 ^ a3;
+  t35 = t34 | ~a1;
+  t36 = a4 & t35;
+  t37 = a2 ^ t36;
+  t38 = ~t6;
+  t39 = a1 | t38;
+  t40 = t39 & ~a5;
+  t41 = t37 ^ t40;
+  t42 = a5 | t34;
+  t43 = t42 & ~a1;
+  t44 = a3 ^ t43;
+  t45 = a1 & a3;
+  t46 = t34 ^ t45;
+  t47 = t46 | ~a5;
+  t48 = t47 & ~a4;
+  t49 = t44 ^ t48;
+  t50 = (a0 & t49) | (t41 & ~a0);
+  t51 = a4 & ~a0;
+  t52 = t51 | ~a2;
+  t53 = a5 ^ t52;
+  t54 = a0 ^ a4;
+  t55 = t54 & ~a3;
+  t56 = t53 ^ t55;
+  t57 = a3 | ~a2;
+  t58 = t57 | ~a0;
+  t59 = a5 & t34;
+  t60 = t59 & ~a0;
+  t61 = a4 & t60;
+  t62 = t58 ^ t61;
+  t63 = a1 & t62;
+  t64 = t56 ^ t63;
+
+  out[5] ^= t64;
+  out[15] ^= t50;
+  out[20] ^= t15;
+  out[31] ^= t33;
+}
+
+static void DESBitsliceS3 (DES_BS_WORD *out, DES_BS_WORD a0, DES_BS_WORD a1,
+  DES_BS_WORD a2, DES_BS_WORD a3, DES_BS_WORD a4, DES_BS_WORD a5)
+{
+  DES_BS_WORD t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13,
+    t14, t15, t16, t17, t18, t19, t20, t21, t22, t23, t24, t25, t26, t27,
+    t28, t29, t30, t31, t32, t33, t34, t35, t36, t37, t38, t39, t40, t41,
+    t42, t43, t44, t45, t46, t47, t48, t49, t50, t51, t52, t53, t54, t55,
+    t56, t57, t58, t59, t60, t61, t62, t63, t64;
+
+  t0 = a3 ^ a4;
+  t1 = a5 & ~a4;
+  t2 = a3 | t1;
+  t3 = t2 & ~a1;
+  t4 = t0 ^ t3;
+  t5 = a5 | ~a1;
+  t6 = a2 & t5;
+  t7 = t4 ^ t6;
+  t8 = a3 & a4;
+  t9 = a2 | t8;
+  t10 = a4 & ~a1;
+  t11 = t9 ^ t10;
+  t12 = t11 | ~a5;
+  t13 = a0 & t12;
+  t14 = t7 ^ t13;
+  t15 = a5 ^ t8;
+  t16 = a1 ^ t15;
+  t17 = a3 ^ a5;
+  t18 = a4 | t17;
+  t19 = t18 | ~a1;
+  t20 = t19 & ~a0;
+  t21 = t16 ^ t20;
+  t22 = a1 ^ a3;
+  t23 = a4 | t22;
+  t24 = t0 | ~a1;
+  t25 = a0 & t24;
+  t26 = t23 ^ t25;
+  t27 = a5 | t26;
+  t28 = t27 & ~a2;
+  t29 = t21 ^ t28;
+  t30 = a4 ^ a5;
+  t31 = a0 ^ t30;
+  t32 = a4 & ~a5;
+  t33 = t32 & ~a0;
+  t34 = a3 | t33;
+  t35 = t34 & ~a1;
+  t36 = t31 ^ t35;
+  t37 = t32 & ~a3;
+  t38 = a1 ^ t37;
+  t39 = a5 & ~a3;
+  t40 = t39 | ~a1;
+  t41 = a4 ^ t40;
+  t42 = a0 & t41;
+  t43 = t38 ^ t42;
+  t44 = a2 & t43;
+  t45 = t36 ^ t44;
+  t46 = a3 ^ t32;
+  t47 = a1 ^ t46;
+  t48 = a3 & a5;
+  t49 = a1 | t48;
+  t50 = a4 & t5;
+  t51 = t49 ^ t50;
+  t52 = a2 & t51;
+  t53 = t47 ^ t52;
+  t54 = ~t30;
+  t55 = a3 | t54;
+  t56 = a3 & t32;
+  t57 = a2 & t56;
+  t58 = t55 ^ t57;
+  t59 = t0 & ~a5;
+  t60 = (a2 & t54) | (t59 & ~a2);
+  t61 = t60 & ~a1;
+  t62 = t58 ^ t61;
+  t63 = t62 & ~a0;
+  t64 = t53 ^ t63;
+
+  out[3] ^= t64;
+  out[9] ^= t29;
+  out[17] ^= t45;
+  out[27] ^= t14;
+}
+
+static void DESBitsliceS4 (DES_BS_WORD *out, DES_BS_WORD a0, DES_BS_WORD a1,
+  DES_BS_WORD a2, DES_BS_WORD a3, DES_BS_WORD a4, DES_BS_WORD a5)
+{
+  DES_BS_WORD t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13,
+    t14, t15, t16, t17, t18, t19, t20, t21, t22, t23, t24, t25, t26, t27,
+    t28, t29, t30, t31, t32, t33, t34, t35, t36, t37, t38, t39, t40, t41,
+    t42, t43, t44, t45, t46, t47, t48, t49, t50, t51, t52, t53, t54, t55,
+    t56, t57, t58, t59;
+
+  t0 = a0 ^ a3;
+  t1 = t0 & ~a4;
+  t2 = a3 | ~a0;
+  t3 = a1 & t2;
+  t4 = t1 ^ t3;
+  t5 = a0 & ~a4;
+  t6 = t5 | ~a3;
+  t7 = a1 | t6;
+  t8 = a5 & t7;
+  t9 = t4 ^ t8;
+  t10 = a3 | ~a5;
+  t11 = t10 | ~a4;
+  t12 = a5 | ~a4;
+  t13 = a1 & t12;
+  t14 = t11 ^ t13;
+  t15 = a3 | ~a1;
+  t16 = t15 & ~a5;
+  t17 = a1 ^ t16;
+  t18 = a1 ^ a3;
+  t19 = a4 & t18;
+  t20 = t17 ^ t19;
+  t21 = a0 & t20;
+  t22 = t14 ^ t21;
+  t23 = t22 & ~a2;
+  t24 = t9 ^ t23;
+  t25 = ~t17;
+  t26 = ~a3;
+  t27 = t26 & ~a4;
+  t28 = t25 ^ t27;
+  t29 = a5 | t18;
+  t30 = (a4 & t29) | (a1 & ~a4);
+  t31 = a2 & t30;
+  t32 = t28 ^ t31;
+  t33 = a1 | t26;
+  t34 = a5 | t15;
+  t35 = t34 & ~a4;
+  t36 = t33 ^ t35;
+  t37 = a5 & t33;
+  t38 = t26 ^ t37;
+  t39 = t18 & ~a4;
+  t40 = t38 ^ t39;
+  t41 = a2 & t40;
+  t42 = t36 ^ t41;
+  t43 = a0 & t42;
+  t44 = t32 ^ t43;
+  t45 = ~t42;
+  t46 = t45 & ~a0;
+  t47 = t32 ^ t46;
+  t48 = ~t38;
+  t49 = a4 & t29;
+  t50 = t48 ^ t49;
+  t51 = a2 & t14;
+  t52 = t50 ^ t51;
+  t53 = t33 | ~a5;
+  t54 = t53 & ~a4;
+  t55 = t15 ^ t54;
+  t56 = t20 & ~a2;
+  t57 = t55 ^ t56;
+  t58 = t57 & ~a0;
+  t59 = t52 ^ t58;
+
+  out[0] ^= t24;
+  out[7] ^= t47;
+  out[13] ^= t44;
+  out[23] ^= t59;
+}
+
+static void DESBitsliceS5 (DES_BS_WORD *out, DES_BS_WORD a0, DES_BS_WORD a1,
+  DES_BS_WORD a2, DES_BS_WORD a3, DES_BS_WORD a4, DES_BS_WORD a5)
+{
+  DES_BS_WORD t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13,
+    t14, t15, t16, t17, t18, t19, t20, t21, t22, t23, t24, t25, t26, t27,
+    t28, t29, t30, t31, t32, t33, t34, t35, t36, t37, t38, t39, t40, t41,
+    t42, t43, t44, t45, t46, t47, t48, t49, t50, t51, t52, t53, t54, t55,
+    t56, t57, t58, t59, t60, t61, t62, t63, t64, t65, t66, t67, t68, t69,
+    t70, t71, t72, t73, t74, t75, t76, t77;
+
+  t0 = a0 & a3;
+  t1 = a5 | t0;
+  t2 = a2 ^ t1;
+  t3 = a3 | a5;
+  t4 = t3 & ~a2;
+  t5 = t4 & ~a0;
+  t6 = a3 ^ t5;
+  t7 = a1 & t6;
+  t8 = t2 ^ t7;
+  t9 = a2 | t3;
+  t10 = a0 | t9;
+  t11 = a2 | ~a0;
+  t12 = a5 & t11;
+  t13 = a2 ^ t12;
+  t14 = a5 | ~a0;
+  t15 = t14 & ~a3;
+  t16 = t13 ^ t15;
+  t17 = t16 & ~a1;
+  t18 = t10 ^ t17;
+  t19 = t18 & ~a4;
+  t20 = t8 ^ t19;
+  t21 = a1 ^ a2;
+  t22 = a0 ^ t21;
+  t23 = a1 | t11;
+  t24 = a3 & t23;
+  t25 = t22 ^ t24;
+  t26 = a2 & ~a3;
+  t27 = t11 ^ t26;
+  t28 = t27 | ~a1;
+  t29 = a5 & t28;
+  t30 = t25 ^ t29;
+  t31 = a3 & a5;
+  t32 = a2 | t31;
+  t33 = a0 & t4;
+  t34 = t32 ^ t33;
+  t35 = a4 & t34;
+  t36 = t30 ^ t35;
+  t37 = a0 ^ a4;
+  t38 = a0 | a4;
+  t39 = t38 & ~a5;
+  t40 = a2 & t39;
+  t41 = t37 ^ t40;
+  t42 = t14 & ~a2;
+  t43 = a4 & t42;
+  t44 = t13 ^ t43;
+  t45 = (a3 & t44) | (t41 & ~a3);
+  t46 = a3 | ~a5;
+  t47 = a2 & a3;
+  t48 = t46 ^ t47;
+  t49 = t48 & ~a0;
+  t50 = t32 ^ t49;
+  t51 = a2 ^ t0;
+  t52 = a0 | a2;
+  t53 = a5 & t52;
+  t54 = t51 ^ t53;
+  t55 = a4 & t54;
+  t56 = t50 ^ t55;
+  t57 = a1 & t56;
+  t58 = t45 ^ t57;
+  t59 = a3 & a4;
+  t60 = a1 | t59;
+  t61 = a3 | ~a4;
+  t62 = t61 & ~a2;
+  t63 = t60 ^ t62;
+  t64 = a1 ^ a3;
+  t65 = a4 | t64;
+  t66 = t65 | ~a2;
+  t67 = t66 & ~a5;
+  t68 = t63 ^ t67;
+  t69 = a2 & ~a5;
+  t70 = t69 | ~a3;
+  t71 = a2 ^ t46;
+  t72 = a4 & t71;
+  t73 = t70 ^ t72;
+  t74 = t73 & ~a1;
+  t75 = t46 ^ t74;
+  t76 = t75 & ~a0;
+  t77 = t68 ^ t76;
+
+  out[8] ^= t20;
+  out[19] ^= t36;
+  out[25] ^= t58;
+  out[30] ^= t77;
+}
+
+static void DESBitsliceS6 (DES_BS_WORD *out, DES_BS_WORD a0, DES_BS_WORD a1,
+  DES_BS_WORD a2, DES_BS_WORD a3, DES_BS_WORD a4, DES_BS_WORD a5)
+{
+  DES_BS_WORD t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13,
+    t14, t15, t16, t17, t18, t19, t20, t21, t22, t23, t24, t25, t26, t27,
+    t28, t29, t30, t31, t32, t33, t34, t35, t36, t37, t38, t39, t40, t41,
+    t42, t43, t44, t45, t46, t47, t48, t49, t50, t51, t52, t53, t54, t55,
+    t56, t57, t58, t59, t60, t61, t62, t63, t64, t65, t66, t67, t68, t69;
+
+  t0 = a5 & ~a3;
+  t1 = a4 ^ t0;
+  t2 = a0 ^ t1;
+  t3 = a0 | a4;
+  t4 = a5 & t3;
+  t5 = t4 | ~a3;
+  t6 = t5 & ~a1;
+  t7 = t2 ^ t6;
+  t8 = a3 & a5;
+  t9 = a0 & t8;
+  t10 = t9 | ~a4;
+  t11 = a3 ^ a4;
+  t12 = t11 & ~a5;
+  t13 = a4 ^ a5;
+  t14 = t13 & ~a0;
+  t15 = t12 ^ t14;
+  t16 = a1 & t15;
+  t17 = t10 ^ t16;
+  t18 = a2 & t17;
+  t19 = t7 ^ t18;
+  t20 = a3 & ~a4;
+  t21 = a4 & ~a3;
+  t22 = t21 | ~a0;
+  t23 = a5 & t22;
+  t24 = t20 ^ t23;
+  t25 = ~t8;
+  t26 = a1 & t25;
+  t27 = t24 ^ t26;
+  t28 = a4 & ~a5;
+  t29 = a1 | t28;
+  t30 = a1 | t11;
+  t31 = t30 & ~a5;
+  t32 = t21 ^ t31;
+  t33 = t32 & ~a0;
+  t34 = t29 ^ t33;
+  t35 = a2 & t34;
+  t36 = t27 ^ t35;
+  t37 = a5 & ~a4;
+  t38 = a1 ^ t37;
+  t39 = a3 & t29;
+  t40 = t38 ^ t39;
+  t41 = t13 | ~a1;
+  t42 = t41 & ~a2;
+  t43 = t40 ^ t42;
+  t44 = a3 | ~a5;
+  t45 = a4 | t8;
+  t46 = ~t37;
+  t47 = a2 & t46;
+  t48 = t45 ^ t47;
+  t49 = a1 & t48;
+  t50 = t44 ^ t49;
+  t51 = t50 & ~a0;
+  t52 = t43 ^ t51;
+  t53 = a5 ^ t21;
+  t54 = t44 & ~a1;
+  t55 = t53 ^ t54;
+  t56 = a1 | a3;
+  t57 = a2 & t56;
+  t58 = t55 ^ t57;
+  t59 = a3 & t46;
+  t60 = a5 ^ t59;
+  t61 = a1 | t60;
+  t62 = a3 & t28;
+  t63 = a3 ^ t46;
+  t64 = t63 & ~a1;
+  t65 = t62 ^ t64;
+  t66 = a2 & t65;
+  t67 = t61 ^ t66;
+  t68 = a0 & t67;
+  t69 = t58 ^ t68;
+
+  out[4] ^= t19;
+  out[14] ^= t36;
+  out[22] ^= t52;
+  out[29] ^= t69;
+}
+
+static void DESBitsliceS7 (DES_BS_WORD *out, DES_BS_WORD a0, DES_BS_WORD a1,
+  DES_BS_WORD a2, DES_BS_WORD a3, DES_BS_WORD a4, DES_BS_WORD a5)
+{
+  DES_BS_WORD t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13,
+    t14, t15, t16, t17, t18, t19, t20, t21, t22, t23, t24, t25, t26, t27,
+    t28, t29, t30, t31, t32, t33, t34, t35, t36, t37, t38, t39, t40, t41,
+    t42, t43, t44, t45, t46, t47, t48, t49, t50, t51, t52, t53, t54, t55,
+    t56, t57, t58, t59, t60, t61, t62, t63, t64;
+
+  t0 = a2 ^ a4;
+  t1 = a4 | ~a2;
+  t2 = a1 & t1;
+  t3 = t2 & ~a0;
+  t4 = t0 ^ t3;
+  t5 = a2 & a4;
+  t6 = a0 ^ t5;
+  t7 = a1 | t6;
+  t8 = a5 & t7;
+  t9 = t4 ^ t8;
+  t10 = a4 | ~a5;
+  t11 = a1 | t10;
+  t12 = a2 & ~a1;
+  t13 = t5 ^ t12;
+  t14 = a5 | t13;
+  t15 = (a0 & t14) | (t11 & ~a0);
+  t16 = a3 & t15;
+  t17 = t9 ^ t16;
+  t18 = a3 | a4;
+  t19 = a5 ^ t18;
+  t20 = a1 ^ t19;
+  t21 = a1 | a3;
+  t22 = a2 & t21;
+  t23 = t20 ^ t22;
+  t24 = a2 ^ a3;
+  t25 = t24 | ~a5;
+  t26 = t25 | ~a4;
+  t27 = a3 & a2;
+  t28 = t0 ^ t27;
+  t29 = a5 & t28;
+  t30 = t5 ^ t29;
+  t31 = t30 & ~a1;
+  t32 = t26 ^ t31;
+  t33 = a0 & t32;
+  t34 = t23 ^ t33;
+  t35 = a1 ^ t6;
+  t36 = a2 | ~a4;
+  t37 = a1 & a2;
+  t38 = t36 ^ t37;
+  t39 = a0 | t38;
+  t40 = a3 & t39;
+  t41 = t35 ^ t40;
+  t42 = a3 & ~a0;
+  t43 = t0 ^ t42;
+  t44 = a0 ^ a4;
+  t45 = t44 & ~a2;
+  t46 = t18 ^ t45;
+  t47 = a1 & t46;
+  t48 = t43 ^ t47;
+  t49 = (a5 & t48) | (t41 & ~a5);
+  t50 = ~t0;
+  t51 = t50 & ~a5;
+  t52 = t5 ^ t51;
+  t53 = a1 ^ t52;
+  t54 = (a5 & t38) | (a4 & ~a5);
+  t55 = a3 & t54;
+  t56 = t53 ^ t55;
+  t57 = (a4 & t25) | (a5 & ~a4);
+  t58 = a4 & ~a5;
+  t59 = a3 ^ t58;
+  t60 = a2 & t59;
+  t61 = a1 & t60;
+  t62 = t57 ^ t61;
+  t63 = a0 & t62;
+  t64 = t56 ^ t63;
+
+  out[1] ^= t49;
+  out[11] ^= t17;
+  out[21] ^= t64;
+  out[26] ^= t34;
+}
+
+static void DESBitsliceS8 (DES_BS_WORD *out, DES_BS_WORD a0, DES_BS_WORD a1,
+  DES_BS_WORD a2, DES_BS_WORD a3, DES_BS_WORD a4, DES_BS_WORD a5)
+{
+  DES_BS_WORD t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13,
+    t14, t15, t16, t17, t18, t19, t20, t21, t22, t23, t24, t25, t26, t27,
+    t28, t29, t30, t31, t32, t33, t34, t35, t36, t37, t38, t39, t40, t41,
+    t42, t43, t44, t45, t46, t47, t48, t49, t50, t51, t52, t53, t54, t55,
+    t56, t57, t58, t59, t60, t61, t62, t63, t64;
+
+  t0 = ~a5;
+  t1 = t0 & ~a3;
+  t2 = a4 | t1;
+  t3 = a2 ^ t2;
+  t4 = a2 | ~a4;
+  t5 = t4 & ~a5;
+  t6 = a3 ^ t5;
+  t7 = t6 & ~a1;
+  t8 = t3 ^ t7;
+  t9 = a3 | ~a1;
+  t10 = a4 | ~a3;
+  t11 = a2 & t10;
+  t12 = t9 ^ t11;
+  t13 = t12 | ~a5;
+  t14 = t13 & ~a0;
+  t15 = t8 ^ t14;
+  t16 = a3 ^ t0;
+  t17 = a3 & t0;
+  t18 = a4 | t17;
+  t19 = a2 & t18;
+  t20 = t16 ^ t19;
+  t21 = a2 ^ a3;
+  t22 = a5 & t21;
+  t23 = t4 ^ t22;
+  t24 = a1 & t23;
+  t25 = t20 ^ t24;
+  t26 = a4 & ~a2;
+  t27 = t16 ^ t26;
+  t28 = ~t10;
+  t29 = t28 | ~a5;
+  t30 = a5 | ~a4;
+  t31 = a2 & t30;
+  t32 = t29 ^ t31;
+  t33 = t32 & ~a1;
+  t34 = t27 ^ t33;
+  t35 = (a0 & t34) | (t25 & ~a0);
+  t36 = ~t34;
+  t37 = a3 | t0;
+  t38 = t37 & ~a4;
+  t39 = a1 & t38;
+  t40 = t2 ^ t39;
+  t41 = a4 | t37;
+  t42 = ~t16;
+  t43 = t42 & ~a1;
+  t44 = t41 ^ t43;
+  t45 = t44 & ~a2;
+  t46 = t40 ^ t45;
+  t47 = a0 & t46;
+  t48 = t36 ^ t47;
+  t49 = a4 ^ t42;
+  t50 = a1 & t17;
+  t51 = t49 ^ t50;
+  t52 = t9 | ~a4;
+  t53 = a5 & t52;
+  t54 = t53 & ~a0;
+  t55 = t51 ^ t54;
+  t56 = a1 | a5;
+  t57 = a4 & t42;
+  t58 = a4 | a5;
+  t59 = t58 & ~a1;
+  t60 = t57 ^ t59;
+  t61 = a0 & t60;
+  t62 = t56 ^ t61;
+  t63 = t62 & ~a2;
+  t64 = t55 ^ t63;
+
+  out[6] ^= t15;
+  out[12] ^= t48;
+  out[18] ^= t64;
+  out[28] ^= t35;
+}
+
+#endif
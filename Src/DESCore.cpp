@@ -0,0 +1,288 @@
+// *****
+// * PROJECT:		DESLib (DES)
+// * FILENAME: 		DESCore.cpp
+// * AUTHOR:		Hector Ho Fuentes
+// *
+// * DESCRIPTION:	C++ cipher core for hosts with a C++14 compiler.  The SP
+// *				tables, the permuted-choice tables and the cooked subkey
+// *				layout are computed at compile time from the FIPS 46
+// *				definitions, and the 16 rounds are unrolled by template
+// *				with every subkey index fixed at compile time.
+// *
+// *				Build with DES_CXX_CORE defined (for this file and for
+// *				DESLibPrv.c) to route DESKey and the single-block table
+// *				rounds through here; Encrypt_DES and Decrypt_DES are
+// *				unchanged.  The Palm build is C and keeps DESTables.h.
+// *
+// * HISTORY:		Hector Ho Fuentes 4/4/2001
+// *
+// *
+// * COPYRIGHT:
+// *
+// *****
+
+#include <PalmOS.h>
+#include "DESLib.h"
+#include "DESLibPrv.h"
+
+namespace {
+
+// FIPS 46 S-boxes, each as four rows of 16 columns.
+constexpr unsigned char kSBox[8][64] = {
+  { 14,  4, 13,  1,  2, 15, 11,  8,  3, 10,  6, 12,  5,  9,  0,  7,
+     0, 15,  7,  4, 14,  2, 13,  1, 10,  6, 12, 11,  9,  5,  3,  8,
+     4,  1, 14,  8, 13,  6,  2, 11, 15, 12,  9,  7,  3, 10,  5,  0,
+    15, 12,  8,  2,  4,  9,  1,  7,  5, 11,  3, 14, 10,  0,  6, 13 },
+  { 15,  1,  8, 14,  6, 11,  3,  4,  9,  7,  2, 13, 12,  0,  5, 10,
+     3, 13,  4,  7, 15,  2,  8, 14, 12,  0,  1, 10,  6,  9, 11,  5,
+     0, 14,  7, 11, 10,  4, 13,  1,  5,  8, 12,  6,  9,  3,  2, 15,
+    13,  8, 10,  1,  3, 15,  4,  2, 11,  6,  7, 12,  0,  5, 14,  9 },
+  { 10,  0,  9, 14,  6,  3, 15,  5,  1, 13, 12,  7, 11,  4,  2,  8,
+    13,  7,  0,  9,  3,  4,  6, 10,  2,  8,  5, 14, 12, 11, 15,  1,
+    13,  6,  4,  9,  8, 15,  3,  0, 11,  1,  2, 12,  5, 10, 14,  7,
+     1, 10, 13,  0,  6,  9,  8,  7,  4, 15, 14,  3, 11,  5,  2, 12 },
+  {  7, 13, 14,  3,  0,  6,  9, 10,  1,  2,  8,  5, 11, 12,  4, 15,
+    13,  8, 11,  5,  6, 15,  0,  3,  4,  7,  2, 12,  1, 10, 14,  9,
+    10,  6,  9,  0, 12, 11,  7, 13, 15,  1,  3, 14,  5,  2,  8,  4,
+     3, 15,  0,  6, 10,  1, 13,  8,  9,  4,  5, 11, 12,  7,  2, 14 },
+  {  2, 12,  4,  1,  7, 10, 11,  6,  8,  5,  3, 15, 13,  0, 14,  9,
+    14, 11,  2, 12,  4,  7, 13,  1,  5,  0, 15, 10,  3,  9,  8,  6,
+     4,  2,  1, 11, 10, 13,  7,  8, 15,  9, 12,  5,  6,  3,  0, 14,
+    11,  8, 12,  7,  1, 14,  2, 13,  6, 15,  0,  9, 10,  4,  5,  3 },
+  { 12,  1, 10, 15,  9,  2,  6,  8,  0, 13,  3,  4, 14,  7,  5, 11,
+    10, 15,  4,  2,  7, 12,  9,  5,  6,  1, 13, 14,  0, 11,  3,  8,
+     9, 14, 15,  5,  2,  8, 12,  3,  7,  0,  4, 10,  1, 13, 11,  6,
+     4,  3,  2, 12,  9,  5, 15, 10, 11, 14,  1,  7,  6,  0,  8, 13 },
+  {  4, 11,  2, 14, 15,  0,  8, 13,  3, 12,  9,  7,  5, 10,  6,  1,
+    13,  0, 11,  7,  4,  9,  1, 10, 14,  3,  5, 12,  2, 15,  8,  6,
+     1,  4, 11, 13, 12,  3,  7, 14, 10, 15,  6,  8,  0,  5,  9,  2,
+     6, 11, 13,  8,  1,  4, 10,  7,  9,  5,  0, 15, 14,  2,  3, 12 },
+  { 13,  2,  8,  4,  6, 15, 11,  1, 10,  9,  3, 14,  5,  0, 12,  7,
+     1, 15, 13,  8, 10,  3,  7,  4, 12,  5,  6, 11,  0, 14,  9,  2,
+     7, 11,  4,  1,  9, 12, 14,  2,  0,  6, 10, 13, 15,  3,  5,  8,
+     2,  1, 14,  7,  4, 10,  8, 13, 15, 12,  9,  0,  3,  5,  6, 11 }
+};
+
+// FIPS 46 permutations, numbered from 1 as in the standard.
+constexpr unsigned char kP[32] = {
+  16,  7, 20, 21, 29, 12, 28, 17,  1, 15, 23, 26,  5, 18, 31, 10,
+   2,  8, 24, 14, 32, 27,  3,  9, 19, 13, 30,  6, 22, 11,  4, 25
+};
+
+constexpr unsigned char kPC1[56] = {
+  57, 49, 41, 33, 25, 17,  9,  1, 58, 50, 42, 34, 26, 18,
+  10,  2, 59, 51, 43, 35, 27, 19, 11,  3, 60, 52, 44, 36,
+  63, 55, 47, 39, 31, 23, 15,  7, 62, 54, 46, 38, 30, 22,
+  14,  6, 61, 53, 45, 37, 29, 21, 13,  5, 28, 20, 12,  4
+};
+
+constexpr unsigned char kPC2[48] = {
+  14, 17, 11, 24,  1,  5,  3, 28, 15,  6, 21, 10,
+  23, 19, 12,  4, 26,  8, 16,  7, 27, 20, 13,  2,
+  41, 52, 31, 37, 47, 55, 30, 40, 51, 45, 33, 48,
+  44, 49, 39, 56, 34, 53, 46, 42, 50, 36, 29, 32
+};
+
+constexpr unsigned char kShifts[16] = {
+  1, 1, 2, 2, 2, 2, 2, 2, 1, 2, 2, 2, 2, 2, 2, 1
+};
+
+struct SPTables {
+  UInt32 sp[8][64];
+};
+
+// Entry j of SP table box: the 6-bit input j = b1..b6 selects row b1b6
+// and column b2..b5, the 4-bit output sits at its place in the 32-bit
+// S-box word, goes through P, and is rotated left one bit to match the
+// rotated halves DESFunction works on.
+constexpr UInt32 SPEntry (int box, int j)
+{
+  int row = ((j >> 4) & 2) | (j & 1);
+  int column = (j >> 1) & 15;
+  UInt32 sbox = (UInt32)kSBox[box][16*row + column] << (28 - 4*box);
+  UInt32 out = 0;
+
+  for (int i = 0; i < 32; i++)
+    if ((sbox >> (32 - kP[i])) & 1)
+      out |= (UInt32)1 << (31 - i);
+  return ((out << 1) | (out >> 31)) & 0xffffffffUL;
+}
+
+constexpr SPTables MakeSPTables ()
+{
+  SPTables t {};
+
+  for (int box = 0; box < 8; box++)
+    for (int j = 0; j < 64; j++)
+      t.sp[box][j] = SPEntry (box, j);
+  return t;
+}
+
+constexpr SPTables kSP = MakeSPTables ();
+
+static_assert (kSP.sp[0][0] == 0x01010400UL && kSP.sp[7][63] == 0x10041000UL,
+               "SP tables do not have the DESFunction layout");
+
+// Total left rotation of C and D before round i.
+constexpr int TotalRotation (int i)
+{
+  int total = 0;
+
+  for (int j = 0; j <= i; j++)
+    total += kShifts[j];
+  return total;
+}
+
+// DESKey and CookKey in one pass: raw 24-bit halves of each round key
+// from PC1, the rotations and PC2, then cooked into the two words per
+// round that the rounds expect, in encryption or decryption order.
+constexpr void MakeSchedule (UInt32 *subkeys, const unsigned char *key, bool encrypt)
+{
+  unsigned char pc1m[56] {}, pcr[56] {};
+
+  for (int j = 0; j < 56; j++) {
+    int l = kPC1[j] - 1;
+    pc1m[j] = (unsigned char)((key[l >> 3] >> (7 - (l & 7))) & 1);
+  }
+  for (int i = 0; i < 16; i++) {
+    UInt32 raw0 = 0, raw1 = 0;
+    int rotation = TotalRotation (i);
+
+    for (int j = 0; j < 28; j++) {
+      pcr[j] = pc1m[(j + rotation) % 28];
+      pcr[j + 28] = pc1m[28 + (j + rotation) % 28];
+    }
+    for (int j = 0; j < 24; j++) {
+      raw0 |= ((UInt32)0x800000UL >> j) & ((UInt32)0 - pcr[kPC2[j] - 1]);
+      raw1 |= ((UInt32)0x800000UL >> j) & ((UInt32)0 - pcr[kPC2[j + 24] - 1]);
+    }
+
+    UInt32 *cooked = &subkeys[2 * (encrypt ? i : 15 - i)];
+    cooked[0] = ((raw0 & 0x00fc0000UL) << 6) | ((raw0 & 0x00000fc0UL) << 10)
+              | ((raw1 & 0x00fc0000UL) >> 10) | ((raw1 & 0x00000fc0UL) >> 6);
+    cooked[1] = ((raw0 & 0x0003f000UL) << 12) | ((raw0 & 0x0000003fUL) << 16)
+              | ((raw1 & 0x0003f000UL) >> 4) | (raw1 & 0x0000003fUL);
+  }
+}
+
+inline void InitialPermutation (UInt32 &left, UInt32 &right)
+{
+  UInt32 work;
+
+  work = ((left >> 4) ^ right) & 0x0f0f0f0fUL;
+  right ^= work;
+  left ^= (work << 4);
+  work = ((left >> 16) ^ right) & 0x0000ffffUL;
+  right ^= work;
+  left ^= (work << 16);
+  work = ((right >> 2) ^ left) & 0x33333333UL;
+  left ^= work;
+  right ^= (work << 2);
+  work = ((right >> 8) ^ left) & 0x00ff00ffUL;
+  left ^= work;
+  right ^= (work << 8);
+  right = ((right << 1) | ((right >> 31) & 1UL)) & 0xffffffffUL;
+  work = (left ^ right) & 0xaaaaaaaaUL;
+  left ^= work;
+  right ^= work;
+  left = ((left << 1) | ((left >> 31) & 1UL)) & 0xffffffffUL;
+}
+
+inline void FinalPermutation (UInt32 &left, UInt32 &right)
+{
+  UInt32 work;
+
+  right = ((right << 31) | (right >> 1)) & 0xffffffffUL;
+  work = (left ^ right) & 0xaaaaaaaaUL;
+  left ^= work;
+  right ^= work;
+  left = ((left << 31) | (left >> 1)) & 0xffffffffUL;
+  work = ((left >> 8) ^ right) & 0x00ff00ffUL;
+  right ^= work;
+  left ^= (work << 8);
+  work = ((left >> 2) ^ right) & 0x33333333UL;
+  right ^= work;
+  left ^= (work << 2);
+  work = ((right >> 16) ^ left) & 0x0000ffffUL;
+  left ^= work;
+  right ^= (work << 16);
+  work = ((right >> 4) ^ left) & 0x0f0f0f0fUL;
+  left ^= work;
+  right ^= (work << 4);
+}
+
+inline void Round (UInt32 &left, UInt32 right, UInt32 k0, UInt32 k1)
+{
+  UInt32 work, fval;
+
+  work  = (((right << 28) | (right >> 4)) & 0xffffffffUL) ^ k0;
+  fval  = kSP.sp[6][ work        & 0x3f];
+  fval |= kSP.sp[4][(work >>  8) & 0x3f];
+  fval |= kSP.sp[2][(work >> 16) & 0x3f];
+  fval |= kSP.sp[0][(work >> 24) & 0x3f];
+  work  = right ^ k1;
+  fval |= kSP.sp[7][ work        & 0x3f];
+  fval |= kSP.sp[5][(work >>  8) & 0x3f];
+  fval |= kSP.sp[3][(work >> 16) & 0x3f];
+  fval |= kSP.sp[1][(work >> 24) & 0x3f];
+  left ^= fval;
+}
+
+// Rounds R..15, alternating which half is updated by swapping the
+// arguments of the next instance.  Encrypt reads a schedule in the order
+// it was cooked; !Encrypt reads the round pairs backwards, so one
+// encryption schedule serves both directions.
+template <int R, bool Encrypt>
+struct Rounds {
+  static inline void Run (UInt32 &left, UInt32 &right, const UInt32 *subkeys)
+  {
+    enum { kPair = 2 * (Encrypt ? R : 15 - R) };
+
+    Round (left, right, subkeys[kPair], subkeys[kPair + 1]);
+    Rounds<R + 1, Encrypt>::Run (right, left, subkeys);
+  }
+};
+
+template <bool Encrypt>
+struct Rounds<16, Encrypt> {
+  static inline void Run (UInt32 &, UInt32 &, const UInt32 *) {}
+};
+
+template <bool Encrypt>
+inline void Cipher (UInt32 *block, const UInt32 *subkeys)
+{
+  UInt32 left = block[0], right = block[1];
+
+  InitialPermutation (left, right);
+  Rounds<0, Encrypt>::Run (left, right, subkeys);
+  FinalPermutation (left, right);
+  block[0] = right;
+  block[1] = left;
+}
+
+} // namespace
+
+extern "C" void DESKeyCxx (UInt32 *subkeys, unsigned char *key, int encrypt)
+{
+  MakeSchedule (subkeys, key, encrypt != 0);
+}
+
+// DES_CTX schedules are already cooked for their direction, so the C
+// entry points always use the forward instance.
+extern "C" void DESFunctionCxx (UInt32 *block, UInt32 *subkeys)
+{
+  Cipher<true> (block, subkeys);
+}
+
+extern "C" void DES3FunctionCxx (UInt32 *block, UInt32 (*subkeys)[32])
+{
+  UInt32 left = block[0], right = block[1];
+
+  InitialPermutation (left, right);
+  Rounds<0, true>::Run (left, right, subkeys[0]);
+  Rounds<0, true>::Run (right, left, subkeys[1]);
+  Rounds<0, true>::Run (left, right, subkeys[2]);
+  FinalPermutation (left, right);
+  block[0] = right;
+  block[1] = left;
+}
@@ -200,6 +200,46 @@ Err DESUnlockGlobals( DESGlobalsTypePtr gP )
 #pragma mark -
 // OS-Required entry point implementations:
 
+// *****
+// * FUNCTION: 		DESProbeKernels
+// * 
+// * DESCRIPTION:	Pick the kernel for each class from the processor we run on.  The
+// *				DragonBall parts (68000 core, no cache, a few KB of stack) do best
+// *				on the classic tables one block at a time; everything else, i.e.
+// *				PACE on ARM and the x86 Simulator, gets the merged tables when
+// *				they are built and the bitsliced engine for runs of blocks.
+// *				ROMs without the processor feature are DragonBall devices.
+// *
+// * PARAMETERS:	gP			-		Locked lib globals
+// *****
+#define DES_PROCESSOR_ARM_FIRST		0x00100000L		// sysFtrNumProcessorARM720T and up
+
+static void DESProbeKernels( DESGlobalsTypePtr gP )
+{
+	UInt32					processor;
+	int						i;
+	
+	if ( FtrGet( sysFtrCreator, sysFtrNumProcessorID, &processor ) )
+		processor = 0;
+	processor &= sysFtrNumProcessorMask;
+
+	if ( processor < DES_PROCESSOR_ARM_FIRST )
+	{
+		gP->probedKernel[DES_CLASS_SINGLE]	= DES_KERNEL_SCALAR;
+		gP->probedKernel[DES_CLASS_MULTI]	= DES_KERNEL_SCALAR;
+		gP->probedKernel[DES_CLASS_DES3]	= DES_KERNEL_SCALAR;
+	}
+	else
+	{
+		gP->probedKernel[DES_CLASS_SINGLE]	= DES_DEFAULT_KERNEL;
+		gP->probedKernel[DES_CLASS_MULTI]	= DES_DEFAULT_MULTI_KERNEL;
+		gP->probedKernel[DES_CLASS_DES3]	= DES_DEFAULT_KERNEL;
+	}
+
+	for ( i = 0; i < DES_CLASSES; i++ )
+		gP->forcedKernel[i] = DES_KERNEL_AUTO;
+}
+
 // *****
 // * FUNCTION: 		DESOpen
 // * 
@@ -241,6 +281,8 @@ DESErr DESOpen( UInt16 uRefNum )
 			
 		// Initialize globals here:
 		gP->iOpenCount = 1;
+		DESProbeKernels( gP );
+		DESKeyCacheInit( &gP->keyCache, TimGetTicks() ^ ((UInt32)SysRandom( 0 ) << 16) );
 
 		// Dump diagnostic info, i.e. "DES ref# %d initially opened; globals initialized.\n", uRefNum
 	}
@@ -290,6 +332,11 @@ DESErr DESClose( UInt16 uRefNum, UInt32* dwRefCountP )
 	ErrNonFatalDisplayIf( gP->iOpenCount < 0, "Library globals underlock." );
 
 	*dwRefCountP = gP->iOpenCount;
+
+	// The globals are about to go back to the heap as they are; wipe the
+	// cached keys and schedules first.
+	if ( gP->iOpenCount <= 0 )
+		MemSet( &gP->keyCache, sizeof(gP->keyCache), 0 );
 		
 	DESUnlockGlobals( gP );
 
@@ -378,6 +425,31 @@ Err DESWake( UInt16 uRefNum )
 #pragma mark -
 // Custom lib function implementation.  These are the extern'd functions.
 
+// DESInitialize and DESInitializeOptions: the context set up with the
+// given options, then given the kernels probed or forced for this device.
+static DESErr DESInitializeContext(UInt16 refNum, unsigned char * keystring, unsigned char * iv, int desmode, int destype, int encrypt, int options, DES_CTX * key)
+{
+	DESGlobalsTypePtr gP;
+	int i;
+
+	if (key->size != sizeof(DES_CTX))
+		return DESErrContextSize;
+
+	gP = DESLockGlobals(refNum);
+	if (Initialize_DESCached(keystring, iv, desmode, destype, encrypt, options, key, gP ? &gP->keyCache : NULL)) {
+		if (gP)
+			DESUnlockGlobals(gP);
+		return DESErrParam;
+	}
+
+	if (gP) {
+		for (i = 0; i < DES_CLASSES; i++)
+			key->kernel[i] = gP->forcedKernel[i] ? gP->forcedKernel[i] : gP->probedKernel[i];
+		DESUnlockGlobals(gP);
+	}
+	return DESErrNone;
+}
+
 /***********************************************************************
  *
  * FUNCTION:    DESInitialize
@@ -387,12 +459,15 @@ Err DESWake( UInt16 uRefNum )
  * PARAMETERS: 
  *				UInt refNum:				A reference number 
  *				unsigned char * keystring:  A string that contains the key. 
- *				unsigned char * iv:			The Initialization Vector
- *				int desmode: 				EBC, CBC, CFB, OFB 
+ *				unsigned char * iv:			The Initialization Vector, or for
+ *											CTR the nonce and first counter
+ *				int desmode: 				EBC, CBC, CFB, OFB, CTR 
  *				int destype:				DES, DESX, DES3 (triple DES)
- *				int encrypt, 
- *				DES_CTX * key 
- * RETURNED:   .
+ *				int encrypt:				ENCRYPT, DECRYPT, or BIDIRECTIONAL for both
+ *				DES_CTX * key:				with key->size set to sizeof(DES_CTX)
+ * RETURNED:   DESErrNone, DESErrContextSize, without touching the rest of
+ *				key, if key->size is not this library's sizeof(DES_CTX),
+ *				or DESErrParam if this build lacks the type or mode.
  *
  *
  *
@@ -405,10 +480,336 @@ Err DESWake( UInt16 uRefNum )
  
 extern DESErr DESInitialize(UInt16 refNum, unsigned char * keystring, unsigned char * iv, int desmode, int destype, int encrypt, DES_CTX * key) 
 {
-	Initialize_DES(keystring, iv, desmode, destype, encrypt, key); 
+	return DESInitializeContext(refNum, keystring, iv, desmode, destype, encrypt, DES_DEFAULT_OPTIONS, key);
+}
+
+
+/***********************************************************************
+ *
+ * FUNCTION:    DESInitializeOptions
+ *
+ * DESCRIPTION: This routine Initializes DES as DESInitialize does, with
+ *				the context's options given rather than DES_DEFAULT_OPTIONS.
+ *				They are in place before the key is scheduled, so a
+ *				DES_OPT_CONSTTIME context never schedules through tables.
+ *
+ * PARAMETERS: 
+ *				UInt refNum:				A reference number 
+ *				unsigned char * keystring:  A string that contains the key. 
+ *				unsigned char * iv:			The Initialization Vector, or for
+ *											CTR the nonce and first counter
+ *				int desmode: 				EBC, CBC, CFB, OFB, CTR 
+ *				int destype:				DES, DESX, DES3 (triple DES)
+ *				int encrypt:				ENCRYPT, DECRYPT, or BIDIRECTIONAL for both
+ *				int options:				DES_OPT_* flags
+ *				DES_CTX * key:				with key->size set to sizeof(DES_CTX)
+ * RETURNED:   DESErrNone, DESErrContextSize, without touching the rest of
+ *				key, if key->size is not this library's sizeof(DES_CTX),
+ *				or DESErrParam if this build lacks the type or mode, or
+ *				for DES_OPT_CONSTTIME in a DES_MINIMAL build.
+ *
+ * REVISION HISTORY:
+ *			Name	Date		Description
+ *			----	----		-----------
+ *		
+ *
+ ***********************************************************************/
+extern DESErr DESInitializeOptions(UInt16 refNum, unsigned char * keystring, unsigned char * iv, int desmode, int destype, int encrypt, int options, DES_CTX * key)
+{
+	return DESInitializeContext(refNum, keystring, iv, desmode, destype, encrypt, options, key);
+}
+
+
+/***********************************************************************
+ *
+ * FUNCTION:    DESInitializeBatch
+ *
+ * DESCRIPTION: This routine Initializes count contexts in one call, as
+ *				DESInitialize would one at a time, with the globals
+ *				locked once for the lot.  Constant-time schedules are
+ *				made 32 keys at a time.  The key-schedule cache is not
+ *				used.
+ *
+ * PARAMETERS: 
+ *				UInt refNum:				A reference number 
+ *				unsigned char * keys:		the keys back to back, 8 bytes each
+ *											for DES and 24 for DESX and DES3
+ *				unsigned char * ivs:		the 8-byte IVs back to back
+ *				int desmode: 				EBC, CBC, CFB, OFB, CTR 
+ *				int destype:				DES, DESX, DES3 (triple DES)
+ *				int encrypt:				ENCRYPT, DECRYPT, or BIDIRECTIONAL for both
+ *				DES_CTX * contexts:			count contexts, each with size set
+ *											to sizeof(DES_CTX)
+ *				unsigned long count:		number of contexts
+ * RETURNED:   DESErrNone, DESErrContextSize, without touching any of the
+ *				contexts, if one's size is not this library's
+ *				sizeof(DES_CTX), or DESErrParam if this build lacks the
+ *				type or mode.
+ *
+ * REVISION HISTORY:
+ *			Name	Date		Description
+ *			----	----		-----------
+ *		
+ *
+ ***********************************************************************/
+extern DESErr DESInitializeBatch(UInt16 refNum, unsigned char * keys, unsigned char * ivs, int desmode, int destype, int encrypt, DES_CTX * contexts, unsigned long count)
+{
+	DESGlobalsTypePtr gP;
+	unsigned long n;
+	int i;
+
+	for (n = 0; n < count; n++)
+		if (contexts[n].size != sizeof(DES_CTX))
+			return DESErrContextSize;
+
+	if (Initialize_DESBatch(keys, ivs, desmode, destype, encrypt, contexts, count))
+		return DESErrParam;
+
+	gP = DESLockGlobals(refNum);
+	if (gP) {
+		for (n = 0; n < count; n++)
+			for (i = 0; i < DES_CLASSES; i++)
+				contexts[n].kernel[i] = gP->forcedKernel[i] ? gP->forcedKernel[i] : gP->probedKernel[i];
+		DESUnlockGlobals(gP);
+	}
+	return DESErrNone;
+}
+
+/***********************************************************************
+ *
+ * FUNCTION:    DESSetIV
+ *
+ * DESCRIPTION: This routine gives an initialized context a new IV without
+ *				recomputing its key schedule.  DES_Restart rewinds to it.
+ *
+ * PARAMETERS: 
+ *				UInt refNum:				A reference number 
+ *				DES_CTX * key:				an initialized context
+ *				unsigned char * iv:			The new Initialization Vector
+ * RETURNED:   DESErrNone
+ *
+ * REVISION HISTORY:
+ *			Name	Date		Description
+ *			----	----		-----------
+ *		
+ *
+ ***********************************************************************/
+extern DESErr DESSetIV(UInt16 refNum, DES_CTX * key, unsigned char * iv)
+{
+	SetIV_DES(key, iv);
+	return DESErrNone;
+}
+
+/***********************************************************************
+ *
+ * FUNCTION:    DESRekey
+ *
+ * DESCRIPTION: This routine gives an initialized context a new key,
+ *				keeping its type, mode, direction and IV.  The schedule
+ *				comes from the key-schedule cache when it can.
+ *
+ * PARAMETERS: 
+ *				UInt refNum:				A reference number 
+ *				DES_CTX * key:				an initialized context
+ *				unsigned char * keystring:  the new key, laid out as for DESInitialize
+ * RETURNED:   DESErrNone, or DESErrLookahead if the context's lookahead
+ *				ring still holds keystream.
+ *
+ * REVISION HISTORY:
+ *			Name	Date		Description
+ *			----	----		-----------
+ *		
+ *
+ ***********************************************************************/
+extern DESErr DESRekey(UInt16 refNum, DES_CTX * key, unsigned char * keystring)
+{
+	DESGlobalsTypePtr gP;
+	int err;
+
+	gP = DESLockGlobals(refNum);
+	err = Rekey_DES(key, keystring, gP ? &gP->keyCache : NULL);
+	if (gP)
+		DESUnlockGlobals(gP);
+	return (DESErr)err;
+}
+
+/***********************************************************************
+ *
+ * FUNCTION:    DESSetMode
+ *
+ * DESCRIPTION: This routine moves an initialized context to another mode,
+ *				keeping its key, direction and IV.  The key schedule is
+ *				reused, turned around in place if the new mode runs the
+ *				cipher the other way.  The segment size n is kept.
+ *
+ * PARAMETERS: 
+ *				UInt refNum:				A reference number 
+ *				DES_CTX * key:				an initialized context
+ *				int desmode: 				EBC, CBC, CFB, OFB, CTR 
+ * RETURNED:   DESErrNone, DESErrParam if this build lacks the mode, or
+ *				DESErrLookahead if the lookahead ring still holds keystream.
+ *
+ * REVISION HISTORY:
+ *			Name	Date		Description
+ *			----	----		-----------
+ *		
+ *
+ ***********************************************************************/
+extern DESErr DESSetMode(UInt16 refNum, DES_CTX * key, int desmode)
+{
+	return (DESErr)SetMode_DES(key, desmode);
+}
+
+/***********************************************************************
+ *
+ * FUNCTION:    DESSetSegment
+ *
+ * DESCRIPTION: This routine sets the segment size of a CFB or OFB
+ *				context: each call then processes the data n bits at a
+ *				time.  DESInitialize starts every context at 64.
+ *
+ * PARAMETERS: 
+ *				UInt refNum:				A reference number 
+ *				DES_CTX * key:				an initialized context
+ *				int n: 						segment size in bits, 1 to 64
+ * RETURNED:   DESErrNone, DESErrParam if n is out of range, or
+ *				DESErrLookahead if the lookahead ring still holds keystream.
+ *
+ * REVISION HISTORY:
+ *			Name	Date		Description
+ *			----	----		-----------
+ *		
+ *
+ ***********************************************************************/
+extern DESErr DESSetSegment(UInt16 refNum, DES_CTX * key, int n)
+{
+	return (DESErr)SetSegment_DES(key, n);
+}
+
+/***********************************************************************
+ *
+ * FUNCTION:    DESSetLookahead
+ *
+ * DESCRIPTION: This routine gives an OFB context a ring buffer for
+ *				keystream made ahead of the data with DESFillLookahead.
+ *				DESEncrypt and DESDecrypt use it up before they run the
+ *				cipher themselves.  The caller owns the buffer; pass NULL
+ *				to take it away again.  DESInitialize starts every
+ *				context without one.  Keystream in the ring is never
+ *				dropped except by DESSetIV or a restart, which rewind the
+ *				register; until it is used up, a new key, mode, segment
+ *				size or ring is refused.
+ *
+ * PARAMETERS: 
+ *				UInt refNum:				A reference number 
+ *				DES_CTX * key:				an initialized OFB context
+ *				unsigned char * buffer:		the ring, or NULL
+ *				unsigned long size:			its size in bytes
+ * RETURNED:   DESErrNone, DESErrParam if the context is not OFB, or
+ *				DESErrLookahead if the ring still holds keystream.
+ *
+ * REVISION HISTORY:
+ *			Name	Date		Description
+ *			----	----		-----------
+ *		
+ *
+ ***********************************************************************/
+extern DESErr DESSetLookahead(UInt16 refNum, DES_CTX * key, unsigned char * buffer, unsigned long size)
+{
+	return (DESErr)SetLookahead_DES(key, buffer, size);
+}
+
+/***********************************************************************
+ *
+ * FUNCTION:    DESFillLookahead
+ *
+ * DESCRIPTION: This routine makes up to bytes bytes of keystream into
+ *				the free part of a context's lookahead ring.  Call it
+ *				from idle time, such as a nilEvent, in slices as large
+ *				as the idle time allows.
+ *
+ * PARAMETERS: 
+ *				UInt refNum:				A reference number 
+ *				DES_CTX * key:				an OFB context with a ring
+ *				unsigned long bytes:		most keystream to make
+ *				unsigned long * madeP:		keystream made, or NULL
+ * RETURNED:   DESErrNone, or DESErrParam, with nothing made, if the
+ *				context is not OFB or has no ring.
+ *
+ * REVISION HISTORY:
+ *			Name	Date		Description
+ *			----	----		-----------
+ *		
+ *
+ ***********************************************************************/
+extern DESErr DESFillLookahead(UInt16 refNum, DES_CTX * key, unsigned long bytes, unsigned long * madeP)
+{
+	unsigned long made;
+	int err;
+
+	err = FillLookahead_DES(key, bytes, &made);
+	if (madeP)
+		*madeP = made;
+	if (err)
+		return DESErrParam;
 	return DESErrNone;
 }
 
+/***********************************************************************
+ *
+ * FUNCTION:    DESSetCounter
+ *
+ * DESCRIPTION: This routine sets how much of a CTR context's IV is the
+ *				counter: the low bits bits count blocks and wrap within
+ *				themselves, and the bits above them are a fixed nonce.
+ *				DESInitialize starts every context at 64.
+ *
+ * PARAMETERS: 
+ *				UInt refNum:				A reference number 
+ *				DES_CTX * key:				an initialized context
+ *				int bits: 					counter width in bits, 1 to 64
+ * RETURNED:   DESErrNone, or DESErrParam if bits is out of range.
+ *
+ * REVISION HISTORY:
+ *			Name	Date		Description
+ *			----	----		-----------
+ *		
+ *
+ ***********************************************************************/
+extern DESErr DESSetCounter(UInt16 refNum, DES_CTX * key, int bits)
+{
+	if (SetCounter_DES(key, bits))
+		return DESErrParam;
+	return DESErrNone;
+}
+
+/***********************************************************************
+ *
+ * FUNCTION:    DESSeek
+ *
+ * DESCRIPTION: This routine moves a CTR context to any byte offset of
+ *				the message that starts at its IV, so DESEncrypt and
+ *				DESDecrypt carry on from there.  Seeking costs one
+ *				block operation at most.
+ *
+ * PARAMETERS: 
+ *				UInt refNum:				A reference number 
+ *				DES_CTX * key:				an initialized CTR context
+ *				unsigned long offset:		bytes from the start
+ * RETURNED:   DESErrNone, or DESErrParam if the context is not CTR.
+ *
+ * REVISION HISTORY:
+ *			Name	Date		Description
+ *			----	----		-----------
+ *		
+ *
+ ***********************************************************************/
+extern DESErr DESSeek(UInt16 refNum, DES_CTX * key, unsigned long offset)
+{
+	if (Seek_DES(key, offset))
+		return DESErrParam;
+	return DESErrNone;
+}
 
 /***********************************************************************
  *
@@ -422,7 +823,10 @@ extern DESErr DESInitialize(UInt16 refNum, unsigned char * keystring, unsigned c
  *				unsigned char * out:	ciphertext
  *				unsigned long size: 	size of data in bytes.
  *
- * RETURNED:    error if found
+ * RETURNED:    1, or DESErrParam, with out untouched, for an ECB or CBC
+ *				size that is not whole blocks, a CFB or OFB segment size
+ *				outside 1 to 64 bits, or a DES_OPT_CONSTTIME context in
+ *				a DES_MINIMAL build.
  *
  * REVISION HISTORY:
  *			Name	Date		Description
@@ -434,7 +838,8 @@ extern DESErr DESInitialize(UInt16 refNum, unsigned char * keystring, unsigned c
 extern Int16	DESEncrypt
 (UInt16 refNum, DES_CTX * key, unsigned char * in, unsigned char * out, unsigned long size)
 {
-	Encrypt_DES(key, in, out, size);
+	if (Encrypt_DES(key, in, out, size))
+		return DESErrParam;
 	return 1;
 }	
 
@@ -450,7 +855,10 @@ extern Int16	DESEncrypt
  *				unsigned char * out:	plaintext
  *				unsigned long size: 	size of data in bytes.
  *
- * RETURNED:    error if found
+ * RETURNED:    1, or DESErrParam, with out untouched, for an ECB or CBC
+ *				size that is not whole blocks, a CFB or OFB segment size
+ *				outside 1 to 64 bits, or a DES_OPT_CONSTTIME context in
+ *				a DES_MINIMAL build.
  *
  * REVISION HISTORY:
  *			Name	Date		Description
@@ -461,6 +869,181 @@ extern Int16	DESEncrypt
 extern Int16 DESDecrypt
 	(UInt16 refNum, DES_CTX * key, unsigned char * in, unsigned char * out, unsigned long size)
 {
-	Decrypt_DES(key, in, out, size);
+	if (Decrypt_DES(key, in, out, size))
+		return DESErrParam;
 	return 1;
-}	
\ No newline at end of file
+}	
+
+/***********************************************************************
+ *
+ * FUNCTION:    DESGetKernel
+ *
+ * DESCRIPTION: This routine reports the kernel DESInitialize gives new
+ *				contexts for one class: the forced one if DESSetKernel
+ *				set it, otherwise the one picked at DESOpen.
+ *
+ * PARAMETERS: 
+ *				UInt refNum:  			A reference number 
+ *				int opclass:			DES_CLASS_SINGLE, DES_CLASS_MULTI, DES_CLASS_DES3
+ *				int * kernelP:			receives a DES_KERNEL_* value
+ *
+ * RETURNED:    DESErrNone, DESErrParam or DESErrNoGlobals
+ *
+ * REVISION HISTORY:
+ *			Name	Date		Description
+ *			----	----		-----------
+ *		
+ *
+ ***********************************************************************/
+extern DESErr DESGetKernel(UInt16 refNum, int opclass, int * kernelP)
+{
+	DESGlobalsTypePtr gP;
+
+	if (opclass < 0 || opclass >= DES_CLASSES || !kernelP)
+		return DESErrParam;
+	gP = DESLockGlobals(refNum);
+	if (!gP)
+		return DESErrNoGlobals;
+	*kernelP = gP->forcedKernel[opclass] ? gP->forcedKernel[opclass] : gP->probedKernel[opclass];
+	DESUnlockGlobals(gP);
+	return DESErrNone;
+}
+
+/***********************************************************************
+ *
+ * FUNCTION:    DESSetKernel
+ *
+ * DESCRIPTION: This routine forces the kernel for one class, for A/B
+ *				comparisons.  It applies to contexts initialized from
+ *				now on; DES_KERNEL_AUTO goes back to the probed kernel.
+ *				To change a context that already exists, store into its
+ *				kernel array instead.
+ *
+ * PARAMETERS: 
+ *				UInt refNum:  			A reference number 
+ *				int opclass:			DES_CLASS_SINGLE, DES_CLASS_MULTI, DES_CLASS_DES3
+ *				int kernel:				a DES_KERNEL_* value
+ *
+ * RETURNED:    DESErrNone, DESErrParam if this build has no such kernel
+ *				for the class, or DESErrNoGlobals
+ *
+ * REVISION HISTORY:
+ *			Name	Date		Description
+ *			----	----		-----------
+ *		
+ *
+ ***********************************************************************/
+extern DESErr DESSetKernel(UInt16 refNum, int opclass, int kernel)
+{
+	DESGlobalsTypePtr gP;
+
+	if (opclass < 0 || opclass >= DES_CLASSES)
+		return DESErrParam;
+	if (kernel != DES_KERNEL_AUTO && !DESKernelValid(opclass, kernel))
+		return DESErrParam;
+	gP = DESLockGlobals(refNum);
+	if (!gP)
+		return DESErrNoGlobals;
+	gP->forcedKernel[opclass] = kernel;
+	DESUnlockGlobals(gP);
+	return DESErrNone;
+}
+
+/***********************************************************************
+ *
+ * FUNCTION:    DESFlushKeyCache
+ *
+ * DESCRIPTION: This routine wipes every key and schedule in the
+ *				key-schedule cache.  The hit and miss counts are kept.
+ *
+ * PARAMETERS: 
+ *				UInt refNum:  			A reference number 
+ *
+ * RETURNED:    DESErrNone or DESErrNoGlobals
+ *
+ * REVISION HISTORY:
+ *			Name	Date		Description
+ *			----	----		-----------
+ *		
+ *
+ ***********************************************************************/
+extern DESErr DESFlushKeyCache(UInt16 refNum)
+{
+	DESGlobalsTypePtr gP;
+
+	gP = DESLockGlobals(refNum);
+	if (!gP)
+		return DESErrNoGlobals;
+	DESKeyCacheFlush(&gP->keyCache);
+	DESUnlockGlobals(gP);
+	return DESErrNone;
+}
+
+/***********************************************************************
+ *
+ * FUNCTION:    DESSetKeyCache
+ *
+ * DESCRIPTION: This routine limits the key-schedule cache to the given
+ *				number of entries (0 turns it off) and flushes it.
+ *
+ * PARAMETERS: 
+ *				UInt refNum:  			A reference number 
+ *				int entries:			0 to DES_KEY_CACHE_SIZE
+ *
+ * RETURNED:    DESErrNone, DESErrParam or DESErrNoGlobals
+ *
+ * REVISION HISTORY:
+ *			Name	Date		Description
+ *			----	----		-----------
+ *		
+ *
+ ***********************************************************************/
+extern DESErr DESSetKeyCache(UInt16 refNum, int entries)
+{
+	DESGlobalsTypePtr gP;
+
+	if (entries < 0 || entries > DES_KEY_CACHE_SIZE)
+		return DESErrParam;
+	gP = DESLockGlobals(refNum);
+	if (!gP)
+		return DESErrNoGlobals;
+	DESKeyCacheFlush(&gP->keyCache);
+	gP->keyCache.limit = entries;
+	DESUnlockGlobals(gP);
+	return DESErrNone;
+}
+
+/***********************************************************************
+ *
+ * FUNCTION:    DESGetKeyCacheStats
+ *
+ * DESCRIPTION: This routine reports how many DESInitialize calls found
+ *				their key schedule in the cache and how many computed it.
+ *
+ * PARAMETERS: 
+ *				UInt refNum:  			A reference number 
+ *				UInt32 * hitsP:			receives the hit count (may be NULL)
+ *				UInt32 * missesP:		receives the miss count (may be NULL)
+ *
+ * RETURNED:    DESErrNone or DESErrNoGlobals
+ *
+ * REVISION HISTORY:
+ *			Name	Date		Description
+ *			----	----		-----------
+ *		
+ *
+ ***********************************************************************/
+extern DESErr DESGetKeyCacheStats(UInt16 refNum, UInt32 * hitsP, UInt32 * missesP)
+{
+	DESGlobalsTypePtr gP;
+
+	gP = DESLockGlobals(refNum);
+	if (!gP)
+		return DESErrNoGlobals;
+	if (hitsP)
+		*hitsP = gP->keyCache.hits;
+	if (missesP)
+		*missesP = gP->keyCache.misses;
+	DESUnlockGlobals(gP);
+	return DESErrNone;
+}
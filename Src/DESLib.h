@@ -40,11 +40,77 @@
 //DES Modes
 #define ECB			1		//ELECTRONIC CODEBOOK MODE
 #define CBC			2		//CIPHER BLOCK CHAINING MODE
-#define CFB			3		//CIPHER FEEDBACK MODE FIPS PUB 81 for only 1, 8, 16, 32 and 64 bits
-#define OFBISO		4		//OUTPUT FEEDBACK MODE ISO 10116 for only 1, 8, 16, 32 and 64 bits
-#define OFBFIPS81	5		//OUTPUT FEEDBACK MODE FIPS PUB 81 for only 1, 8, 16, 32 and 64 bits.
+#define CFB			3		//CIPHER FEEDBACK MODE FIPS PUB 81 in n-bit segments, n from 1 to 64
+#define OFBISO		4		//OUTPUT FEEDBACK MODE ISO 10116 in n-bit segments, n from 1 to 64
+#define OFBFIPS81	5		//OUTPUT FEEDBACK MODE FIPS PUB 81 in n-bit segments, n from 1 to 64
+#define CTR			6		//COUNTER MODE NIST SP 800-38A, the counter in the low bits of the IV
 #define ENCRYPT 1
 #define DECRYPT 0
+#define BIDIRECTIONAL 2		//Encrypt_DES encrypts and Decrypt_DES decrypts on one context
+
+//DES Options (DES_CTX.options).  DESInitialize sets them to
+//DES_DEFAULT_OPTIONS and DESInitializeOptions to the caller's; set or clear
+//bits afterwards to change one context.  DES_OPT_CONSTTIME covers the key
+//schedule made while it is set, so a context that must never schedule
+//through tables gets it from DESInitializeOptions, not afterwards.
+#define DES_OPT_CONSTTIME	0x0002		//bitsliced rounds and masked key schedule, no secret-indexed table reads
+#define DES_OPT_LEGACY_FEEDBACK	0x0004	//DES and DESX CFB-16, OFB-1 and DESX ISO OFB as earlier releases
+											//laid them out, not FIPS 81 / ISO 10116; only for reading old data,
+											//since OFB-1 leaves bits 57 and 58 of every block in the clear
+
+#ifndef DES_DEFAULT_OPTIONS
+#if defined(DES_CONSTANT_TIME)
+#define DES_DEFAULT_OPTIONS	DES_OPT_CONSTTIME
+#else
+#define DES_DEFAULT_OPTIONS	0
+#endif
+#endif
+
+//DES Kernel classes (DES_CTX.kernel index).  Each context runs its
+//blocks through one kernel per class; DESOpen picks them for the
+//processor, DESInitialize copies them in, and DESGetKernel and
+//DESSetKernel report or force the library's choice.  Store into
+//DES_CTX.kernel after DESInitialize to change one context.
+#define DES_CLASS_SINGLE	0		//one block at a time: CBC encrypt, CFB, OFB
+#define DES_CLASS_MULTI		1		//independent blocks: ECB, CBC decrypt
+#define DES_CLASS_DES3		2		//one block through fused triple DES
+#define DES_CLASSES			3
+
+//DES Kernels
+#define DES_KERNEL_AUTO			0		//DESSetKernel only: back to the probed kernel
+#define DES_KERNEL_SCALAR		1		//classic SP tables, one block at a time
+#define DES_KERNEL_BIGSP		2		//merged 4 x 4096 SP tables (DES_BIG_SP builds, single and DES3)
+#define DES_KERNEL_INTERLEAVED	3		//2, 4 or 8 blocks with their rounds interleaved (multi)
+#define DES_KERNEL_BITSLICE		4		//bitsliced; multi batches 32 blocks, the tail interleaved
+
+#ifndef DES_DEFAULT_KERNEL
+#if defined(DES_BIG_SP)
+#define DES_DEFAULT_KERNEL	DES_KERNEL_BIGSP
+#else
+#define DES_DEFAULT_KERNEL	DES_KERNEL_SCALAR
+#endif
+#endif
+
+#ifndef DES_DEFAULT_MULTI_KERNEL
+#if defined(DES_MINIMAL)
+#define DES_DEFAULT_MULTI_KERNEL	DES_KERNEL_SCALAR
+#else
+#define DES_DEFAULT_MULTI_KERNEL	DES_KERNEL_BITSLICE
+#endif
+#endif
+
+//Smallest ECB or CBC-decrypt call, in bytes, that streams past the cache
+//(DES_CTX.streamMin); well above a last-level cache on the hosts that can.
+#ifndef DES_DEFAULT_STREAM_MIN
+#define DES_DEFAULT_STREAM_MIN	0x01000000L		//16 MB
+#endif
+
+//Worker threads for a large CTR or CBC-decrypt call (DES_CTX.threads),
+//0 for one per online processor.  Only DES_THREADS host builds have threads; the Palm
+//library runs every call on the caller's thread.
+#ifndef DES_DEFAULT_THREADS
+#define DES_DEFAULT_THREADS	0
+#endif
 
 // These are possible error types that DES might return:
 typedef enum tagDESErrEnum
@@ -56,7 +122,9 @@ typedef enum tagDESErrEnum
 	/////
 	// Your custom return codes go here...
 	/////
-	DESErrKeySize			= -3
+	DESErrKeySize			= -3,
+	DESErrLookahead			= -4,		// OFB keystream still waiting in the lookahead ring
+	DESErrContextSize		= -5		// DES_CTX.size is not this library's sizeof(DES_CTX)
 	
 } DESErr;
 
@@ -81,19 +149,55 @@ typedef enum tagDESTrapNumEnum
 
 	DESTrapDESInitialize = sysLibTrapCustom,		// libDispatchEntry(4)
 	DESTrapDESEncrypt,								// libDispatchEntry(5)
-	DESTrapDESDecrypt								// libDispatchEntry(6)
+	DESTrapDESDecrypt,								// libDispatchEntry(6)
+	DESTrapDESGetKernel,							// libDispatchEntry(7)
+	DESTrapDESSetKernel,							// libDispatchEntry(8)
+	DESTrapDESFlushKeyCache,						// libDispatchEntry(9)
+	DESTrapDESSetKeyCache,							// libDispatchEntry(10)
+	DESTrapDESGetKeyCacheStats,						// libDispatchEntry(11)
+	DESTrapDESInitializeBatch,						// libDispatchEntry(12)
+	DESTrapDESSetIV,								// libDispatchEntry(13)
+	DESTrapDESRekey,								// libDispatchEntry(14)
+	DESTrapDESSetMode,								// libDispatchEntry(15)
+	DESTrapDESSetSegment,							// libDispatchEntry(16)
+	DESTrapDESSetLookahead,							// libDispatchEntry(17)
+	DESTrapDESFillLookahead,						// libDispatchEntry(18)
+	DESTrapDESSetCounter,							// libDispatchEntry(19)
+	DESTrapDESSeek,									// libDispatchEntry(20)
+	DESTrapDESInitializeOptions						// libDispatchEntry(21)
 } DESTrapNumEnum;
 
 typedef struct{
-	int desmode;										 /* ECB, CBC, CFB, OFB */	
+	int desmode;									/* ECB, CBC, CFB, OFB, CTR */	
 	int destype;											/* DES, DESX, DES3 */
-	int n;								/*a number between 1 and 64 for OFB and  between 1 and 63 for CFB*/ 	
+	int n;				/*CFB and OFB segment size in bits, 1 to 64; 64 after initialization*/ 	
 	UInt32 subkeys[3][32];                            /* 3 subkeys due to DES3 */
   UInt32 iv[2];                                       /* initializing vector */
   UInt32 inputWhitener[2];                                 /* input whitener */
   UInt32 outputWhitener[2];                               /* output whitener */
   UInt32 originalIV[2];                        /* for restarting the context */
   int encrypt; 
+  /* The fields above are laid out as in the first release; new ones go
+     only at the end.  size follows them so that DESInitialize can tell a
+     caller built against this header from one built against an older,
+     shorter DES_CTX, and refuse the latter before writing past it.
+   */
+  UInt32 size;              /* sizeof(DES_CTX), set by the caller first */
+  UInt32 preWhitener[2];          /* DESX whitener applied first, IP domain */
+  UInt32 postWhitener[2];          /* DESX whitener applied last, IP domain */
+  int bidirectional;          /* initialized with BIDIRECTIONAL; see encrypt */
+  int options;                                        /* DES_OPT_* flags */
+  int kernel[DES_CLASSES];                 /* DES_KERNEL_* for each class */
+  unsigned long streamMin;  /* ECB/CBC call size that streams, 0 for never */
+  UInt32 keystream[2];      /* CFB/OFB segment the last call stopped inside */
+  int keystreamUsed;               /* bits of keystream used, 0 for none */
+  int blockBits;      /* CFB/OFB bits into the current 64-bit block */
+  unsigned char *ahead;            /* OFB keystream ring, SetLookahead_DES */
+  unsigned long aheadSize;                      /* ring size in bytes */
+  unsigned long aheadStart;              /* offset of the oldest byte */
+  unsigned long aheadCount;             /* bytes made and not yet used */
+  int counterBits;      /* CTR counter width in bits, 1 to 64; 64 at first */
+  int threads;     /* CTR, CBC decrypt threads, 0 for one per processor */
 }DES_CTX;
 
 #ifdef __cplusplus
@@ -109,12 +213,57 @@ extern Err		DESWake	( UInt16 uRefNum )						SYS_TRAP ( sysLibTrapWake	);
 // Here are the actual functions we want the library to extend to callers.
 extern DESErr	DESInitialize(UInt16 refNum, unsigned char *keystring, unsigned char *iv, int desmode, int destype, int encrypt, DES_CTX *key) 
 				SYS_TRAP(DESTrapDESInitialize);
+
+extern DESErr	DESInitializeOptions(UInt16 refNum, unsigned char *keystring, unsigned char *iv, int desmode, int destype, int encrypt, int options, DES_CTX *key)
+				SYS_TRAP(DESTrapDESInitializeOptions);
+
+extern DESErr	DESInitializeBatch(UInt16 refNum, unsigned char *keys, unsigned char *ivs, int desmode, int destype, int encrypt, DES_CTX *contexts, unsigned long count)
+				SYS_TRAP(DESTrapDESInitializeBatch);
+
+extern DESErr	DESSetIV(UInt16 refNum, DES_CTX *key, unsigned char *iv)
+				SYS_TRAP(DESTrapDESSetIV);
+
+extern DESErr	DESRekey(UInt16 refNum, DES_CTX *key, unsigned char *keystring)
+				SYS_TRAP(DESTrapDESRekey);
+
+extern DESErr	DESSetMode(UInt16 refNum, DES_CTX *key, int desmode)
+				SYS_TRAP(DESTrapDESSetMode);
+
+extern DESErr	DESSetSegment(UInt16 refNum, DES_CTX *key, int n)
+				SYS_TRAP(DESTrapDESSetSegment);
+
+extern DESErr	DESSetLookahead(UInt16 refNum, DES_CTX *key, unsigned char *buffer, unsigned long size)
+				SYS_TRAP(DESTrapDESSetLookahead);
+
+extern DESErr	DESFillLookahead(UInt16 refNum, DES_CTX *key, unsigned long bytes, unsigned long *madeP)
+				SYS_TRAP(DESTrapDESFillLookahead);
+
+extern DESErr	DESSetCounter(UInt16 refNum, DES_CTX *key, int bits)
+				SYS_TRAP(DESTrapDESSetCounter);
+
+extern DESErr	DESSeek(UInt16 refNum, DES_CTX *key, unsigned long offset)
+				SYS_TRAP(DESTrapDESSeek);
 				
 extern Int16	DESEncrypt(UInt16 refNum, DES_CTX * key, unsigned char * in, unsigned char * out, unsigned long size) 
 				SYS_TRAP(DESTrapDESEncrypt);
 				
 extern Int16 	DESDecrypt(UInt16 refNum, DES_CTX * key, unsigned char * in, unsigned char * out, unsigned long size) 
 				SYS_TRAP(DESTrapDESDecrypt);
+
+extern DESErr	DESGetKernel(UInt16 refNum, int opclass, int *kernelP)
+				SYS_TRAP(DESTrapDESGetKernel);
+
+extern DESErr	DESSetKernel(UInt16 refNum, int opclass, int kernel)
+				SYS_TRAP(DESTrapDESSetKernel);
+
+extern DESErr	DESFlushKeyCache(UInt16 refNum)
+				SYS_TRAP(DESTrapDESFlushKeyCache);
+
+extern DESErr	DESSetKeyCache(UInt16 refNum, int entries)
+				SYS_TRAP(DESTrapDESSetKeyCache);
+
+extern DESErr	DESGetKeyCacheStats(UInt16 refNum, UInt32 *hitsP, UInt32 *missesP)
+				SYS_TRAP(DESTrapDESGetKeyCacheStats);
 				
 #ifdef __cplusplus
 }
@@ -61,7 +61,7 @@ Err __Startup__( UInt16 uRefNum, SysLibTblEntryPtr entryP )
 }
 
 #define prvJmpSize	4				// How many bytes a JMP instruction occupies
-#define NUMBER_OF_FUNCTIONS	7		// Don't forget to update this if necessary!!
+#define NUMBER_OF_FUNCTIONS	22		// Don't forget to update this if necessary!!
 
 #define TABLE_OFFSET 			2 * (NUMBER_OF_FUNCTIONS + 1)
 
@@ -110,6 +110,21 @@ static MemPtr	asm	DES_DispatchTable( void )
 	DC.W		DES_DISPATCH_SLOT(4)						// DESInitilize
 	DC.W		DES_DISPATCH_SLOT(5)						// DESTrapEncrypt
 	DC.W		DES_DISPATCH_SLOT(6)						// DESTrapDecrypt
+	DC.W		DES_DISPATCH_SLOT(7)						// DESTrapGetKernel
+	DC.W		DES_DISPATCH_SLOT(8)						// DESTrapSetKernel
+	DC.W		DES_DISPATCH_SLOT(9)						// DESTrapFlushKeyCache
+	DC.W		DES_DISPATCH_SLOT(10)						// DESTrapSetKeyCache
+	DC.W		DES_DISPATCH_SLOT(11)						// DESTrapGetKeyCacheStats
+	DC.W		DES_DISPATCH_SLOT(12)						// DESTrapInitializeBatch
+	DC.W		DES_DISPATCH_SLOT(13)						// DESTrapSetIV
+	DC.W		DES_DISPATCH_SLOT(14)						// DESTrapRekey
+	DC.W		DES_DISPATCH_SLOT(15)						// DESTrapSetMode
+	DC.W		DES_DISPATCH_SLOT(16)						// DESTrapSetSegment
+	DC.W		DES_DISPATCH_SLOT(17)						// DESTrapSetLookahead
+	DC.W		DES_DISPATCH_SLOT(18)						// DESTrapFillLookahead
+	DC.W		DES_DISPATCH_SLOT(19)						// DESTrapSetCounter
+	DC.W		DES_DISPATCH_SLOT(20)						// DESTrapSeek
+	DC.W		DES_DISPATCH_SLOT(21)						// DESTrapInitializeOptions
 	
 	
 	JMP			DESOpen									// 0
@@ -119,6 +134,21 @@ static MemPtr	asm	DES_DispatchTable( void )
 	JMP			DESInitialize							// 4
 	JMP			DESEncrypt								// 5
 	JMP			DESDecrypt								// 6
+	JMP			DESGetKernel							// 7
+	JMP			DESSetKernel							// 8
+	JMP			DESFlushKeyCache						// 9
+	JMP			DESSetKeyCache							// 10
+	JMP			DESGetKeyCacheStats						// 11
+	JMP			DESInitializeBatch						// 12
+	JMP			DESSetIV								// 13
+	JMP			DESRekey								// 14
+	JMP			DESSetMode								// 15
+	JMP			DESSetSegment							// 16
+	JMP			DESSetLookahead							// 17
+	JMP			DESFillLookahead						// 18
+	JMP			DESSetCounter							// 19
+	JMP			DESSeek									// 20
+	JMP			DESInitializeOptions					// 21
 	
 	
 @LibName:
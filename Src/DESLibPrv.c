@@ -18,13 +18,371 @@
 #include "DESLib.h"
 #include "DESLibPrv.h"
 
+/* The word-wide key schedule and its PC2 tables, for contexts without
+   DES_OPT_CONSTTIME.  Constant-time and compact builds carry only the
+   bit-at-a-time schedule, which indexes nothing by key bits.
+ */
+#if !defined(DES_CXX_CORE) && !defined(DES_COMPACT_TABLES) && !defined(DES_CONSTANT_TIME)
+#define DES_KEY_TABLES 1
+#endif
+
+#include "DESTables.h"
+#ifndef DES_MINIMAL
+#include "DESBitslice.h"
+#endif
+
 #define RE_LEN 0x0406
 
+#define DES_MB_LANES	8				// Blocks per multi-block table batch
+#define DES_MB_MIN		2				// Fewest blocks worth batching
+#define DES_KEY_LANES	32				// Keys per Initialize_DESBatch schedule pass
+
+/* Handed down as the cache by Initialize_DESBatch, which writes the
+   schedules itself afterwards, so DESScheduleKeys leaves them alone.
+ */
+#define DES_KEYS_BATCHED	((DESKeyCache *)-1)
+
+/* 64-bit GCC-style hosts move a block between bytes and halves as one
+   unaligned 64-bit load or store plus a byte swap, instead of eight byte
+   accesses.  Define DES_NO_PACK64 to use the byte loops everywhere.
+ */
+#if defined(__GNUC__) && (defined(__LP64__) || defined(_WIN64)) && !defined(DES_NO_PACK64)
+#define DES_PACK64 1
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define DES_BIG_ENDIAN64(v)	(v)
+#else
+#define DES_BIG_ENDIAN64(v)	__builtin_bswap64 (v)
+#endif
+#endif
+
+/* Large-buffer streaming.  ECB and CBC-decrypt calls of at least
+   context->streamMin bytes prefetch their input DES_STREAM_AHEAD bytes
+   ahead of the kernels and, on x86-64 hosts, write the output with
+   non-temporal stores, so a pass over a buffer much larger than the cache
+   does not evict everyone else's lines.  Where neither is available the
+   calls take the usual path.
+ */
+#define DES_STREAM_AHEAD	512				// Prefetch distance in bytes
+#define DES_CACHE_LINE		64
+
+#if defined(__GNUC__)
+#define DES_PREFETCH(address)	__builtin_prefetch ((address), 0, 0)
+#else
+#define DES_PREFETCH(address)
+#endif
+
+#if defined(DES_PACK64) && defined(__SSE2__) && defined(__x86_64__)
+#include <emmintrin.h>
+#define DES_STREAM_STORES 1
+#endif
+
+/* CTR makes its counter blocks a batch at a time, so the keystream goes
+   through the same multi-block kernels as ECB: a bitsliced batch where
+   the context has DES_KERNEL_BITSLICE, interleaved blocks otherwise.
+   DES_MINIMAL has neither, so a batch there would only take stack.
+ */
+#ifdef DES_MINIMAL
+#define DES_CTR_BATCH		1				// Counter blocks enciphered at once
+#else
+#define DES_CTR_BATCH		DES_BS_LANES
+#endif
+
+/* DES_THREADS host builds split a CTR or CBC-decrypt call of at least
+   DES_THREAD_MIN bytes per thread into that many pieces, each with its
+   own starting counter or IV, and run them on context->threads threads
+   at once (one per online processor when 0).  The workers only read the
+   context.
+ */
+#ifdef DES_THREADS
+#include <pthread.h>
+#include <unistd.h>
+#define DES_THREAD_MIN		0x10000L		// Fewest bytes worth a thread
+#define DES_THREAD_MAX		16				// Most threads per call
+
+typedef struct
+{
+	DES_CTX		*context;
+	unsigned char *output;
+	unsigned char *input;
+	unsigned long blocks;
+	UInt32		iv[2];					// the piece's first counter block, or CBC IV
+	int			destype;
+	pthread_t	thread;
+} DESThreadJob;
+#endif
+
+/* Single-block cipher calls for the mode loops, on the kernel the
+   context holds for the class.  Builds with DES_BIG_SP carry the
+   merged-table DESFunctionBig as well, for DES_KERNEL_BIGSP; DES_CXX_CORE
+   builds use the unrolled rounds in DESCore.cpp for the table kernels;
+   other builds always use the classic tables.  DES_KERNEL_BITSLICE and
+   contexts with DES_OPT_CONSTTIME run the block through the bitsliced
+   engine instead, as a batch of one.
+ */
+#define DES_KERNEL_IS(context, opclass, which) ((context)->kernel[opclass] == (which))
+
+#if defined(DES_CXX_CORE)
+#define DES_TABLE_FUNCTION(context, block, subkeys) DESFunctionCxx (block, subkeys)
+#define DES3_TABLE_FUNCTION(context, block, subkeys) DES3FunctionCxx (block, subkeys)
+#elif defined(DES_BIG_SP)
+#define DES_TABLE_FUNCTION(context, block, subkeys) \
+  (DES_KERNEL_IS (context, DES_CLASS_SINGLE, DES_KERNEL_BIGSP) ? DESFunctionBig (block, subkeys) : DESFunction (block, subkeys))
+#define DES3_TABLE_FUNCTION(context, block, subkeys) \
+  (DES_KERNEL_IS (context, DES_CLASS_DES3, DES_KERNEL_BIGSP) ? DES3FunctionBig (block, subkeys) : DES3Function (block, subkeys))
+#else
+#define DES_TABLE_FUNCTION(context, block, subkeys) DESFunction (block, subkeys)
+#define DES3_TABLE_FUNCTION(context, block, subkeys) DES3Function (block, subkeys)
+#endif
+
+#ifdef DES_MINIMAL
+#define DES_FUNCTION(context, block, subkeys) DES_TABLE_FUNCTION (context, block, subkeys)
+#define DES3_FUNCTION(context, block, subkeys) DES3_TABLE_FUNCTION (context, block, subkeys)
+#else
+#define DES_BITSLICED(context, opclass) \
+  (((context)->options & DES_OPT_CONSTTIME) || DES_KERNEL_IS (context, opclass, DES_KERNEL_BITSLICE))
+#define DES_FUNCTION(context, block, subkeys) \
+  (DES_BITSLICED (context, DES_CLASS_SINGLE) ? DESBitslice (block, (UInt32 (*)[32])(subkeys), 1, 1) : DES_TABLE_FUNCTION (context, block, subkeys))
+#define DES3_FUNCTION(context, block, subkeys) \
+  (DES_BITSLICED (context, DES_CLASS_DES3) ? DESBitslice (block, subkeys, 3, 1) : DES3_TABLE_FUNCTION (context, block, subkeys))
+#endif
+
+/* The same operations on a block kept in the IP domain, for feedback
+   loops whose cipher output goes straight back into the cipher.  halves
+   holds IP (block) as (left, right) and is replaced by IP (E (block)).
+   DES_TO_IP and DES_FROM_IP convert between a packed block and halves.
+ */
+#ifdef DES_BIG_SP
+#define DES_TABLE_ROUNDS(context, opclass, halves, subkeys) \
+  (DES_KERNEL_IS (context, opclass, DES_KERNEL_BIGSP) ? DESRoundsBig (halves, subkeys) : DESRounds (halves, subkeys))
+#else
+#define DES_TABLE_ROUNDS(context, opclass, halves, subkeys) DESRounds (halves, subkeys)
+#endif
+
+#ifdef DES_MINIMAL
+#define DES_ROUNDS(context, halves, subkeys) DES_TABLE_ROUNDS (context, DES_CLASS_SINGLE, halves, subkeys)
+#define DES3_ROUNDS(context, halves, subkeys) \
+  (DES_TABLE_ROUNDS (context, DES_CLASS_DES3, halves, subkeys[0]), DES_TABLE_ROUNDS (context, DES_CLASS_DES3, halves, subkeys[1]), \
+   DES_TABLE_ROUNDS (context, DES_CLASS_DES3, halves, subkeys[2]))
+#else
+#define DES_ROUNDS(context, halves, subkeys) \
+  (DES_BITSLICED (context, DES_CLASS_SINGLE) ? DESRoundsBitslice (halves, (UInt32 (*)[32])(subkeys), 1) : \
+   DES_TABLE_ROUNDS (context, DES_CLASS_SINGLE, halves, subkeys))
+#define DES3_ROUNDS(context, halves, subkeys) \
+  (DES_BITSLICED (context, DES_CLASS_DES3) ? DESRoundsBitslice (halves, subkeys, 3) : \
+   (DES_TABLE_ROUNDS (context, DES_CLASS_DES3, halves, subkeys[0]), DES_TABLE_ROUNDS (context, DES_CLASS_DES3, halves, subkeys[1]), \
+    DES_TABLE_ROUNDS (context, DES_CLASS_DES3, halves, subkeys[2])))
+#endif
+
+#define DES_TO_IP(halves, block, work) \
+  {                                    \
+    halves[0] = block[0];              \
+    halves[1] = block[1];              \
+    DES_IP (halves[0], halves[1], work); \
+  }
+#define DES_FROM_IP(block, halves, work) \
+  {                                      \
+    block[0] = halves[0];                \
+    block[1] = halves[1];                \
+    DES_FP (block[1], block[0], work);   \
+  }
+
+/* Initial and final permutations, as swap-moves on the two block halves.
+   DES_IP also applies the one-bit rotation the round loop expects, and
+   DES_FP undoes it; the caller stores the result as (right, left).
+ */
+#define DES_IP(left, right, work)                                \
+  {                                                              \
+    work = ((left >> 4) ^ right) & 0x0f0f0f0fL;                  \
+    right ^= work;                                               \
+    left ^= (work << 4);                                         \
+    work = ((left >> 16) ^ right) & 0x0000ffffL;                 \
+    right ^= work;                                               \
+    left ^= (work << 16);                                        \
+    work = ((right >> 2) ^ left) & 0x33333333L;                  \
+    left ^= work;                                                \
+    right ^= (work << 2);                                        \
+    work = ((right >> 8) ^ left) & 0x00ff00ffL;                  \
+    left ^= work;                                                \
+    right ^= (work << 8);                                        \
+    right = ((right << 1) | ((right >> 31) & 1L)) & 0xffffffffL; \
+    work = (left ^ right) & 0xaaaaaaaaL;                         \
+    left ^= work;                                                \
+    right ^= work;                                               \
+    left = ((left << 1) | ((left >> 31) & 1L)) & 0xffffffffL;    \
+  }
+
+#define DES_FP(left, right, work)                \
+  {                                              \
+    right = (right << 31) | (right >> 1);        \
+    work = (left ^ right) & 0xaaaaaaaaL;         \
+    left ^= work;                                \
+    right ^= work;                               \
+    left = (left << 31) | (left >> 1);           \
+    work = ((left >> 8) ^ right) & 0x00ff00ffL;  \
+    right ^= work;                               \
+    left ^= (work << 8);                         \
+    work = ((left >> 2) ^ right) & 0x33333333L;  \
+    right ^= work;                               \
+    left ^= (work << 2);                         \
+    work = ((right >> 16) ^ left) & 0x0000ffffL; \
+    left ^= work;                                \
+    right ^= (work << 16);                       \
+    work = ((right >> 4) ^ left) & 0x0f0f0f0fL;  \
+    left ^= work;                                \
+    right ^= (work << 4);                        \
+  }
+
+/* One DES round on the permuted halves: left ^= f(right, k0:k1).
+   DES_ROUND takes the key pair from subkeys and advances past it.
+ */
+#ifdef DES_COMPACT_TABLES
+#define DES_ROUND_KEYS(left, right, k0, k1, fval, work) \
+  {                                                     \
+    work = (right);                                     \
+    fval = DESCompactF (work, k0, k1);                  \
+    left ^= fval;                                       \
+  }
+#else
+#define DES_ROUND_KEYS(left, right, k0, k1, fval, work) \
+  {                                                     \
+    work  = (right << 28) | (right >> 4);               \
+    work ^= (k0);                                       \
+    fval  = SP7[ work        & 0x3fL];                  \
+    fval |= SP5[(work >>  8) & 0x3fL];                  \
+    fval |= SP3[(work >> 16) & 0x3fL];                  \
+    fval |= SP1[(work >> 24) & 0x3fL];                  \
+    work  = right ^ (k1);                               \
+    fval |= SP8[ work        & 0x3fL];                  \
+    fval |= SP6[(work >>  8) & 0x3fL];                  \
+    fval |= SP4[(work >> 16) & 0x3fL];                  \
+    fval |= SP2[(work >> 24) & 0x3fL];                  \
+    left ^= fval;                                       \
+  }
+#endif
+
+#define DES_ROUND(left, right, subkeys, fval, work)                \
+  {                                                                \
+    DES_ROUND_KEYS (left, right, subkeys[0], subkeys[1], fval, work); \
+    subkeys += 2;                                                  \
+  }
+
 static void Unpack(unsigned char *, UInt32 *);
 static void Pack(UInt32 *, unsigned char *);
-static void DESKey(UInt32 *, unsigned char *, int);
+#ifndef DES_MINIMAL
+static void UnpackBlocks(unsigned char *, UInt32 *, int);
+static void PackBlocks(UInt32 *, unsigned char *, int);
+#ifdef DES_STREAM_STORES
+static void UnpackBlocksStream(unsigned char *, UInt32 *, int);
+#endif
+#endif
+static void DESKey(UInt32 *, unsigned char *, int, int);
+#ifndef DES_CXX_CORE
+#ifdef DES_KEY_TABLES
+static void DESKeyTables(UInt32 *, unsigned char *, int);
+#endif
 static void CookKey(UInt32 *, UInt32 *, int);
+#endif
+#ifdef DES_COMPACT_TABLES
+static UInt32 DESCompactF(UInt32, UInt32, UInt32);
+#endif
+#ifndef DES_CXX_CORE
 static void DESFunction(UInt32 *, UInt32 *);
+#ifndef DES_NO_DES3
+static void DES3Function(UInt32 *, UInt32 (*)[32]);
+#endif
+#endif
+#if !defined(DES_NO_OFB) || !defined(DES_NO_DESX)
+static void DESRounds(UInt32 *, UInt32 *);
+#endif
+#ifndef DES_NO_DESX
+static void DESXFunction(DES_CTX *, UInt32 *);
+static void DESXWhiteners(DES_CTX *);
+#endif
+#if !defined(DES_NO_CFB) || !defined(DES_NO_OFB) || !defined(DES_NO_CTR) || (defined(DES_THREADS) && !defined(DES_NO_CBC))
+static void DESFeedbackFunction(DES_CTX *, UInt32 *, int);
+#endif
+#if !defined(DES_NO_OFB) || !defined(DES_NO_CTR)
+static void DESXorBytes(unsigned char *, unsigned char *, unsigned char *, unsigned long);
+#endif
+#if !defined(DES_NO_CFB) || !defined(DES_NO_OFB)
+static int DESFeedback(DES_CTX *, unsigned char *, unsigned char *, unsigned long, int, int);
+static int DESFeedbackRun(DES_CTX *, unsigned char *, unsigned long, int, int);
+static void DESFeedbackNext(DES_CTX *, UInt32 *, UInt32 *, int, int, int, int);
+#if !defined(DES_NO_DESX) && !defined(DES_NO_OFB)
+static void DESRotateLeft(UInt32 *, UInt32 *, int);
+#endif
+#ifndef DES_NO_OFB
+static void DESFeedbackRounds(DES_CTX *, UInt32 *, int);
+#endif
+static void DESShiftIn(UInt32 *, UInt32 *, int);
+static void DESMaskSegment(UInt32 *, int);
+static void DESLoadSegment(UInt32 *, unsigned char *, unsigned long, int);
+static void DESXorSegment(unsigned char *, unsigned long, UInt32 *, int);
+#ifndef DES_NO_OFB
+static unsigned long DESUseLookahead(DES_CTX *, unsigned char *, unsigned long);
+#endif
+#endif
+#ifndef DES_NO_CTR
+static int DESCounter(DES_CTX *, unsigned char *, unsigned char *, unsigned long, int);
+static void DESCounterRun(DES_CTX *, unsigned char *, unsigned char *, unsigned long, int);
+static void DESCounterBlocks(DES_CTX *, unsigned char *, unsigned char *, unsigned long, UInt32 *, int);
+static void DESCounterAdd(UInt32 *, int, unsigned long);
+static void DESCounterKeystream(DES_CTX *, int);
+#ifdef DES_THREADS
+static void *DESCounterJob(void *);
+#endif
+#endif
+#ifndef DES_NO_CBC
+static unsigned long DESChainRun(DES_CTX *, unsigned char *, unsigned char *, unsigned long, int);
+#ifdef DES_THREADS
+static void DESChainBlocks(DES_CTX *, unsigned char *, unsigned char *, unsigned long, UInt32 *, int);
+static void *DESChainJob(void *);
+#endif
+#endif
+#if defined(DES_THREADS) && (!defined(DES_NO_CTR) || !defined(DES_NO_CBC))
+static void DESRunThreads(DESThreadJob *, int, void *(*)(void *));
+static int DESThreadCount(DES_CTX *, unsigned long);
+#endif
+static int DESSupported(int, int);
+static void DESScheduleKeys(DES_CTX *, unsigned char *, int, DESKeyCache *);
+#ifndef DES_MINIMAL
+static void DESScheduleBatch(DES_CTX *, unsigned char *, int, int, int, int, int);
+static void DESTranspose32(UInt32 *);
+#endif
+static void DESSetDirection(DES_CTX *, int);
+static void DESReverseSchedule(DES_CTX *);
+static UInt32 DESKeyCacheTag(DESKeyCache *, unsigned char *, int, int, int);
+static int DESKeyDiffers(unsigned char *, unsigned char *, int);
+#ifdef DES_BIG_SP
+#ifndef DES_CXX_CORE
+static void DESFunctionBig(UInt32 *, UInt32 *);
+#ifndef DES_NO_DES3
+static void DES3FunctionBig(UInt32 *, UInt32 (*)[32]);
+#endif
+#endif
+#if !defined(DES_NO_OFB) || !defined(DES_NO_DESX)
+static void DESRoundsBig(UInt32 *, UInt32 *);
+#endif
+static void DESBigSPReady(void);
+static void DESBigSPInit(void);
+#endif
+#ifdef DES_MINIMAL
+/* No multi-block kernels: every block goes one at a time.  The arguments
+   are still evaluated, for nothing, so callers' parameters count as used.
+ */
+#define DESMultiBlock(context, output, input, blocks, pre, post, passes, chain) \
+  ((void)(context), (void)(output), (void)(input), (void)(blocks),            \
+   (void)(pre), (void)(post), (void)(passes), (void)(chain), 0)
+#else
+#if !defined(DES_NO_OFB) || !defined(DES_NO_DESX)
+static void DESRoundsBitslice(UInt32 *, UInt32 (*)[32], int);
+#endif
+static void DESBitslice(UInt32 *, UInt32 (*)[32], int, int);
+static void DESFunctionBlocks(UInt32 *, UInt32 (*)[32], int, int);
+static void DESFunction2(UInt32 *, UInt32 (*)[32], int);
+static void DESFunction4(UInt32 *, UInt32 (*)[32], int);
+static unsigned long DESMultiBlock(DES_CTX *, unsigned char *, unsigned char *, unsigned long, UInt32 *, UInt32 *, int, UInt32 *);
+#endif
 
  /***********************************************************************
  *
@@ -48,7 +406,7 @@ static void DESFunction(UInt32 *, UInt32 *);
  *
  ***********************************************************************/
  
-void DES_Init (DES_CTX *context, unsigned char key[], unsigned char iv[], int encrypt)
+void DES_Init (DES_CTX *context, unsigned char key[], unsigned char iv[], int encrypt, DESKeyCache *cache)
 {  
   /* Copy encrypt flag to context.
    */
@@ -64,13 +422,14 @@ void DES_Init (DES_CTX *context, unsigned char key[], unsigned char iv[], int en
 
   /* Precompute key schedule
    */
-  if((context->desmode == OFBISO) || (context->desmode == CFB)|| (context->desmode == OFBFIPS81)) 
-  DESKey (context->subkeys[0], key, ENCRYPT);
+  if((context->desmode == OFBISO) || (context->desmode == CFB)|| (context->desmode == OFBFIPS81) || (context->desmode == CTR)) 
+  DESScheduleKeys (context, key, ENCRYPT, cache);
   else 
-  DESKey (context->subkeys[0], key, context->encrypt);
+  DESScheduleKeys (context, key, context->encrypt, cache);
   
 }
 
+#ifndef DES_NO_ECB
  /***********************************************************************
  *
  * FUNCTION:    DES_ECBpdate
@@ -97,18 +456,22 @@ void DES_Init (DES_CTX *context, unsigned char key[], unsigned char iv[], int en
 int DES_ECBUpdate (DES_CTX *context, unsigned char *output, unsigned char *input, unsigned long len)
 {
   UInt32 inputBlock[2], work[2];
-  int i;
+  unsigned long i;
   
   if (len % 8)
     return (RE_LEN);
 
-  for (i = 0; i < len/8; i++) {
+  /* Runs of blocks go through the multi-block kernels, the rest one at a time.
+   */
+  i = DESMultiBlock (context, output, input, len/8, NULL, NULL, 1, NULL);
+
+  for (; i < len/8; i++) {
     Pack (inputBlock, &input[8*i]);
         
   work[0] = inputBlock[0];
   work[1] = inputBlock[1];         
 
-  DESFunction(work, context->subkeys[0]);
+  DES_FUNCTION (context, work, context->subkeys[0]);
 
   Unpack (&output[8*i], work);
   }
@@ -119,7 +482,9 @@ int DES_ECBUpdate (DES_CTX *context, unsigned char *output, unsigned char *input
   */
   return (0);
 }
+#endif
 
+#ifndef DES_NO_CBC
 /***********************************************************************
  *
  * FUNCTION:    DES_CBCUpdate
@@ -146,12 +511,20 @@ int DES_ECBUpdate (DES_CTX *context, unsigned char *output, unsigned char *input
 int DES_CBCUpdate (DES_CTX *context, unsigned char *output, unsigned char *input, unsigned long len)
 {
   UInt32 inputBlock[2], work[2];
-  int i;
+  unsigned long i;
   
   if (len % 8)
     return (RE_LEN);
 
-  for (i = 0; i < len/8; i++) {
+  /* Decryption has no chaining dependency between cipher operations, so
+     runs of blocks go through the multi-block kernels, and in DES_THREADS
+     builds large runs through several threads.  Encryption is serial.
+   */
+  i = 0;
+  if (!context->encrypt)
+    i = DESChainRun (context, output, input, len/8, DES);
+
+  for (; i < len/8; i++) {
     Pack (inputBlock, &input[8*i]);
         
     /* Chain if encrypting.
@@ -165,7 +538,7 @@ int DES_CBCUpdate (DES_CTX *context, unsigned char *output, unsigned char *input
       work[1] = inputBlock[1];         
     }
 
-    DESFunction(work, context->subkeys[0]);
+    DES_FUNCTION (context, work, context->subkeys[0]);
 
     /* Chain if decrypting, then update IV.
      */
@@ -188,14 +561,16 @@ int DES_CBCUpdate (DES_CTX *context, unsigned char *output, unsigned char *input
   */
   return (0);
 }
+#endif
 
+#ifndef DES_NO_CFB
 /***********************************************************************
  *
  * FUNCTION:    DES_CFBUpdate
  *
  * DESCRIPTION: DES-CFB block update operation. Continues a DES-CFB encryption
- *  			operation, processing eight-byte message blocks, and updating
- *  			the context.
+ *  			operation, processing n-bit segments, and updating the context.
+ *				len may end inside a segment; the next call resumes it.
  *
  * PARAMETERS: 
  *				DES_CTX *context: 	context 
@@ -214,124 +589,18 @@ int DES_CBCUpdate (DES_CTX *context, unsigned char *output, unsigned char *input
  ***********************************************************************/
 int DES_CFBUpdate (DES_CTX *context, unsigned char *output, unsigned char *input, unsigned long len)
 {
-  UInt32 inputBlock[2], work[2], outputBlocks[2];
-  int i,j, rounds, maxlen, nbitshift;
-  UInt8 tempBlocks[8];
-  
-  maxlen=len/8;
-  rounds = 64/context->n;
-  nbitshift = context->n;
-  
-  if ((nbitshift == 8) || (nbitshift == 16) || (nbitshift == 32) || (nbitshift == 64) || (nbitshift == 1)){
-    
-  for (i = 0; i < maxlen; i++) {
-   
-    Pack (inputBlock, &input[8*i]);
-    
-    for(j=0;j<8;j++) tempBlocks[j]=0;
-    outputBlocks[0]=0;
-    outputBlocks[1]=0;
-   
-    for(j=0; j < rounds ; j++){    
-   		work[0] = context->iv[0];
-   		work[1] = context->iv[1];
-			
-	    DESFunction(work, context->subkeys[0]);
-		
-	   	
-		
-		if(nbitshift==1){
-				if(j<8) tempBlocks[0] =  tempBlocks[0] | (((UInt8) (work[0]>>31) &0x00000001) << (7-j)); 
-				else if (j<16) tempBlocks[1] =  tempBlocks[1] | (((UInt8) (work[0]>>31) &0x00000001) <<(15-j)); 
-				else if (j<24) tempBlocks[2] =  tempBlocks[2] | (((UInt8) (work[0]>>31) &0x00000001) <<(23-j)); 
-				else if (j<32) tempBlocks[3] =  tempBlocks[3] | (((UInt8) (work[0]>>31) &0x00000001) <<(31-j));
-				else if (j<40) tempBlocks[4] =  tempBlocks[4] | (((UInt8) (work[0]>>31) &0x00000001) <<(39-j));
-				else if (j<48) tempBlocks[5] =  tempBlocks[5] | (((UInt8) (work[0]>>31) &0x00000001) <<(47-j));
-				else if (j<56) tempBlocks[6] =  tempBlocks[6] | (((UInt8) (work[0]>>31) &0x00000001) <<(55-j)); 
-				else tempBlocks[7] =  tempBlocks[7] | (((UInt8) (work[0]>>31) &0x00000001) <<(61-j));
-				context->iv[0] = (context->iv[0]<<1)| ((context->iv[1] >> 31) & 0x00000001);
-			   
-				if(context->encrypt==ENCRYPT) 
-			   		context->iv[1] = (context->iv[1]<<1)| (((work[0] >> 31) ^ (inputBlock[j/32]>>(31-(j%32)))) & 0x00000001);
-				else 
-					context->iv[1] = (context->iv[1]<<1)| (inputBlock[j/32]>>(31-(j%32)) & 0x00000001);
-				
-			}
-		else if(nbitshift == 8){  
-				tempBlocks[j]= (UInt8) (work[0]>>24); 
-				context->iv[0] = (context->iv[0]<<8)| ((context->iv[1] >> 24) & 0x000000FF);
-			   	if(context->encrypt==ENCRYPT) 
-			   		context->iv[1] = (context->iv[1]<<8)| (((work[0] >> 24) ^ (inputBlock[j/4]>>(24-(j%4)*8))) & 0x000000FF);
-				else 
-					context->iv[1] = (context->iv[1]<<8)| (inputBlock[j/4]>>(24-(j%4)*8) & 0x000000FF);
-				}
-		else if (nbitshift == 16){
-				tempBlocks[2*j]= (UInt8) (work[0]>>24); 
-				tempBlocks[2*j+1]= (UInt8) ((work[0]>>16)&0x000000FF);
-				
-				context->iv[0] = (context->iv[0]<<16)| ((context->iv[1] >> 16) & 0x0000FFFF);
-			   	context->iv[1] = (context->iv[1]<<16)| ((work[0] >> 16) & 0x0000FFFF);
-			   	if(context->encrypt==ENCRYPT) 
-			   		context->iv[1] = (context->iv[1]<<16)| (((work[0] >> 16) ^ (inputBlock[j/2]>>(16-(j%2)*16))) & 0x0000FFFF);
-				else 
-					context->iv[1] = (context->iv[1]<<16)| (inputBlock[j/2]>>(16-(j%2)*16) & 0x0000FFFF);
-				}
-		else if (nbitshift == 32){
-				tempBlocks[4*j]= (UInt8) 	(work[0]>>24); 
-				tempBlocks[4*j+1]= (UInt8) ((work[0]>>16)&0x000000FF);
-				tempBlocks[4*j+2]= (UInt8) ((work[0]>>8)&0x000000FF); 
-				tempBlocks[4*j+3]= (UInt8) (work[0]&0x000000FF);
-				context->iv[0] = context->iv[1];
-			   	if(context->encrypt==ENCRYPT)
-				   	context->iv[1] = work[0] ^ inputBlock[j%2];
-				else context->iv[1] = inputBlock[j%2];		   	
-			   	}
-		else {
-				tempBlocks[0]= (UInt8) 	(work[0]>>24); 
-				tempBlocks[1]= (UInt8) ((work[0]>>16)&0x000000FF);
-				tempBlocks[2]= (UInt8) ((work[0]>>8)&0x000000FF); 
-				tempBlocks[3]= (UInt8) (work[0]&0x000000FF);
-				tempBlocks[4]= (UInt8) 	(work[1]>>24); 
-				tempBlocks[5]= (UInt8) ((work[1]>>16)&0x000000FF);
-				tempBlocks[6]= (UInt8) ((work[1]>>8)&0x000000FF); 
-				tempBlocks[7]= (UInt8) (work[1]&0x000000FF);
-				if(context->encrypt==ENCRYPT){
-				context->iv[0] = work[0] ^ inputBlock[0];
-			   	context->iv[1] = work[1] ^ inputBlock[1];
-			   	}
-			   	else
-			   	{
-			   	context->iv[0] = inputBlock[0];
-			   	context->iv[1] = inputBlock[1];
-			   	}
-				}
-		}
-   	Pack (outputBlocks, &tempBlocks[0]);
-   	inputBlock[0]^=outputBlocks[0];
-   	inputBlock[1]^=outputBlocks[1];
-    Unpack (&output[8*i], inputBlock);
-
-  
-  }
-  
-  /* Zeroize sensitive information.
-  R_memset ((POINTER)inputBlock, 0, sizeof (inputBlock));
-  R_memset ((POINTER)work, 0, sizeof (work));
-  */
-  return (0);
-  }
-  
-
-  else return RE_LEN;
+  return DESFeedback (context, output, input, len, DES, CFB);
 }
+#endif
 
+#ifndef DES_NO_OFB
 /***********************************************************************
  *
  * FUNCTION:    DES_OFBISOUpdate
  *
  * DESCRIPTION: DES-OFB block update operation. Continues a DES-OFB encryption
- *  			operation.  Note:  If n is not equal to 1, 8, 16, 32, or 64
- *				an error will be returned.
+ *  			operation in n-bit segments, n from 1 to 64.  len may end
+ *				inside a segment; the next call resumes it.
  *
  * PARAMETERS: 
  *				DES_CTX *context: 	context 
@@ -350,92 +619,18 @@ int DES_CFBUpdate (DES_CTX *context, unsigned char *output, unsigned char *input
  ***********************************************************************/
 int DES_OFBISOUpdate (DES_CTX *context, unsigned char *output, unsigned char *input, unsigned long len)
 {
-  UInt32 inputBlock[2], work[2], outputBlocks[2];
-  int i,j, rounds, maxlen, nbitshift;
-  UInt8 tempBlocks[8];
-  
-  maxlen=len/8;
-  rounds = 64/context->n;
-  nbitshift = context->n;
-  
-  if ((nbitshift == 8) || (nbitshift == 16) || (nbitshift == 32) || (nbitshift == 64) || (nbitshift == 1)){
-    
-  for (i = 0; i < maxlen; i++) {
-   
-    Pack (inputBlock, &input[8*i]);
-    
-    for(j=0;j<8;j++) tempBlocks[j]=0;
-    outputBlocks[0]=0;
-    outputBlocks[1]=0;
-   
-    for(j=0; j < rounds ; j++){    
-   		work[0] = context->iv[0];
-   		work[1] = context->iv[1];
-			
-	    DESFunction(work, context->subkeys[0]);
-		
-	   	context->iv[0] = work[0];
-	   	context->iv[1] = work[1];
-		
-		if(nbitshift==1){
-				if(j<8) tempBlocks[0] =  tempBlocks[0] | (((UInt8) (work[0]>>31) &0x00000001) << (7-j)); 
-				else if (j<16) tempBlocks[1] =  tempBlocks[1] | (((UInt8) (work[0]>>31) &0x00000001) <<(15-j)); 
-				else if (j<24) tempBlocks[2] =  tempBlocks[2] | (((UInt8) (work[0]>>31) &0x00000001) <<(23-j)); 
-				else if (j<32) tempBlocks[3] =  tempBlocks[3] | (((UInt8) (work[0]>>31) &0x00000001) <<(31-j));
-				else if (j<40) tempBlocks[4] =  tempBlocks[4] | (((UInt8) (work[0]>>31) &0x00000001) <<(39-j));
-				else if (j<48) tempBlocks[5] =  tempBlocks[5] | (((UInt8) (work[0]>>31) &0x00000001) <<(47-j));
-				else if (j<56) tempBlocks[6] =  tempBlocks[6] | (((UInt8) (work[0]>>31) &0x00000001) <<(55-j)); 
-				else tempBlocks[7] =  tempBlocks[7] | (((UInt8) (work[0]>>31) &0x00000001) <<(61-j));
-			}
-		else if(nbitshift == 8){  
-				tempBlocks[j]= (UInt8) (work[0]>>24); 
-				}
-		else if (nbitshift == 16){
-				tempBlocks[2*j]= (UInt8) (work[0]>>24); 
-				tempBlocks[2*j+1]= (UInt8) ((work[0]>>16)&0x000000FF);
-				}
-		else if (nbitshift == 32){
-				tempBlocks[4*j]= (UInt8) 	(work[0]>>24); 
-				tempBlocks[4*j+1]= (UInt8) ((work[0]>>16)&0x000000FF);
-				tempBlocks[4*j+2]= (UInt8) ((work[0]>>8)&0x000000FF); 
-				tempBlocks[4*j+3]= (UInt8) (work[0]&0x000000FF);
-				}
-		else {
-				tempBlocks[0]= (UInt8) 	(work[0]>>24); 
-				tempBlocks[1]= (UInt8) ((work[0]>>16)&0x000000FF);
-				tempBlocks[2]= (UInt8) ((work[0]>>8)&0x000000FF); 
-				tempBlocks[3]= (UInt8) (work[0]&0x000000FF);
-				tempBlocks[4]= (UInt8) 	(work[1]>>24); 
-				tempBlocks[5]= (UInt8) ((work[1]>>16)&0x000000FF);
-				tempBlocks[6]= (UInt8) ((work[1]>>8)&0x000000FF); 
-				tempBlocks[7]= (UInt8) (work[1]&0x000000FF);
-				}
-		}
-   	Pack (outputBlocks, &tempBlocks[0]);
-   	inputBlock[0]^=outputBlocks[0];
-   	inputBlock[1]^=outputBlocks[1];
-    Unpack (&output[8*i], inputBlock);
-  
-  }
-  
-  /* Zeroize sensitive information.
-  R_memset ((POINTER)inputBlock, 0, sizeof (inputBlock));
-  R_memset ((POINTER)work, 0, sizeof (work));
-  */
-  return (0);
-  }
-  
-
-  else return RE_LEN;
+  return DESFeedback (context, output, input, len, DES, OFBISO);
 }
+#endif
 
+#ifndef DES_NO_OFB
 /***********************************************************************
  *
  * FUNCTION:    DES_OFBFIPS81Update
  *
  * DESCRIPTION: DES-OFB block update operation. Continues a DES-OFB encryption
- *  			operation.  Note:  If n is not equal to 1, 8, 16, 32, or 64
- *				an error will be returned.
+ *  			operation in n-bit segments, n from 1 to 64.  len may end
+ *				inside a segment; the next call resumes it.
  *
  * PARAMETERS: 
  *				DES_CTX *context: 	context 
@@ -454,94 +649,39 @@ int DES_OFBISOUpdate (DES_CTX *context, unsigned char *output, unsigned char *in
  ***********************************************************************/
 int DES_OFBFIPS81Update (DES_CTX *context, unsigned char *output, unsigned char *input, unsigned long len)
 {
-  UInt32 inputBlock[2], work[2], outputBlocks[2];
-  int i,j, rounds, maxlen, nbitshift;
-  UInt8 tempBlocks[8];
-  
-  maxlen=len/8;
-  rounds = 64/context->n;
-  nbitshift = context->n;
-  
-  if ((nbitshift == 8) || (nbitshift == 16) || (nbitshift == 32) || (nbitshift == 64) || (nbitshift == 1)){
-    
-  for (i = 0; i < maxlen; i++) {
-   
-    Pack (inputBlock, &input[8*i]);
-    
-    for(j=0;j<8;j++) tempBlocks[j]=0;
-    outputBlocks[0]=0;
-    outputBlocks[1]=0;
-   
-    for(j=0; j < rounds ; j++){    
-   		work[0] = context->iv[0];
-   		work[1] = context->iv[1];
-			
-	    DESFunction(work, context->subkeys[0]);
-		
-	   	
-		
-		if(nbitshift==1){
-				if(j<8) tempBlocks[0] =  tempBlocks[0] | (((UInt8) (work[0]>>31) &0x00000001) << (7-j)); 
-				else if (j<16) tempBlocks[1] =  tempBlocks[1] | (((UInt8) (work[0]>>31) &0x00000001) <<(15-j)); 
-				else if (j<24) tempBlocks[2] =  tempBlocks[2] | (((UInt8) (work[0]>>31) &0x00000001) <<(23-j)); 
-				else if (j<32) tempBlocks[3] =  tempBlocks[3] | (((UInt8) (work[0]>>31) &0x00000001) <<(31-j));
-				else if (j<40) tempBlocks[4] =  tempBlocks[4] | (((UInt8) (work[0]>>31) &0x00000001) <<(39-j));
-				else if (j<48) tempBlocks[5] =  tempBlocks[5] | (((UInt8) (work[0]>>31) &0x00000001) <<(47-j));
-				else if (j<56) tempBlocks[6] =  tempBlocks[6] | (((UInt8) (work[0]>>31) &0x00000001) <<(55-j)); 
-				else tempBlocks[7] =  tempBlocks[7] | (((UInt8) (work[0]>>31) &0x00000001) <<(61-j));
-				context->iv[0] = (context->iv[0]<<1)| ((context->iv[1] >> 31) & 0x00000001);
-			   	context->iv[1] = (context->iv[1]<<1)| ((work[0] >> 31) & 0x00000001);
-			}
-		else if(nbitshift == 8){  
-				tempBlocks[j]= (UInt8) (work[0]>>24); 
-				context->iv[0] = (context->iv[0]<<8)| ((context->iv[1] >> 24) & 0x000000FF);
-			   	context->iv[1] = (context->iv[1]<<8)| ((work[0] >> 24) & 0x000000FF);
-				}
-		else if (nbitshift == 16){
-				tempBlocks[2*j]= (UInt8) (work[0]>>24); 
-				tempBlocks[2*j+1]= (UInt8) ((work[0]>>16)&0x000000FF);
-				context->iv[0] = (context->iv[0]<<16)| ((context->iv[1] >> 16) & 0x0000FFFF);
-			   	context->iv[1] = (context->iv[1]<<16)| ((work[0] >> 16) & 0x0000FFFF);
-				}
-		else if (nbitshift == 32){
-				tempBlocks[4*j]= (UInt8) 	(work[0]>>24); 
-				tempBlocks[4*j+1]= (UInt8) ((work[0]>>16)&0x000000FF);
-				tempBlocks[4*j+2]= (UInt8) ((work[0]>>8)&0x000000FF); 
-				tempBlocks[4*j+3]= (UInt8) (work[0]&0x000000FF);
-				context->iv[0] = context->iv[1];
-			   	context->iv[1] = work[0];
-				}
-		else {
-				tempBlocks[0]= (UInt8) 	(work[0]>>24); 
-				tempBlocks[1]= (UInt8) ((work[0]>>16)&0x000000FF);
-				tempBlocks[2]= (UInt8) ((work[0]>>8)&0x000000FF); 
-				tempBlocks[3]= (UInt8) (work[0]&0x000000FF);
-				tempBlocks[4]= (UInt8) 	(work[1]>>24); 
-				tempBlocks[5]= (UInt8) ((work[1]>>16)&0x000000FF);
-				tempBlocks[6]= (UInt8) ((work[1]>>8)&0x000000FF); 
-				tempBlocks[7]= (UInt8) (work[1]&0x000000FF);
-				context->iv[0] = work[0];
-			   	context->iv[1] = work[1];
-				}
-		}
-   	Pack (outputBlocks, &tempBlocks[0]);
-   	inputBlock[0]^=outputBlocks[0];
-   	inputBlock[1]^=outputBlocks[1];
-    Unpack (&output[8*i], inputBlock);
-
-  
-  }
-  
-  /* Zeroize sensitive information.
-  R_memset ((POINTER)inputBlock, 0, sizeof (inputBlock));
-  R_memset ((POINTER)work, 0, sizeof (work));
-  */
-  return (0);
-  }
-  
+  return DESFeedback (context, output, input, len, DES, OFBFIPS81);
+}
+#endif
 
-  else return RE_LEN;
+#ifndef DES_NO_CTR
+/***********************************************************************
+ *
+ * FUNCTION:    DES_CTRUpdate
+ *
+ * DESCRIPTION: DES-CTR block update operation. Continues a DES-CTR encryption
+ *  			or decryption, one keystream block per counter value.  len
+ *				may end inside a block; the next call resumes it.
+ *
+ * PARAMETERS: 
+ *				DES_CTX *context: 	context 
+ *				unsigned char *output: 	output block 
+ *				unsigned char *input: 	input block 
+ *				unsigned int len: 		length of input and output blocks 
+ *
+ *
+ * RETURNED:    nothing
+ *
+ * REVISION HISTORY:
+ *			Name	Date		Description
+ *			----	----		-----------
+ *			
+ *
+ ***********************************************************************/
+int DES_CTRUpdate (DES_CTX *context, unsigned char *output, unsigned char *input, unsigned long len)
+{
+  return DESCounter (context, output, input, len, DES);
 }
+#endif
 /***********************************************************************
  *
  * FUNCTION:    DES_CBCRestart
@@ -565,8 +705,12 @@ void DES_Restart (DES_CTX *context)
   /* Reset to the original IV */
   context->iv[0] = context->originalIV[0];
   context->iv[1] = context->originalIV[1];
+  context->keystreamUsed = 0;
+  context->blockBits = 0;
+  context->aheadCount = 0;
 }
 
+#ifndef DES_NO_DESX
 /***********************************************************************
  *
  * FUNCTION:    DESX_Init
@@ -589,7 +733,7 @@ void DES_Restart (DES_CTX *context)
  *			
  *
  ***********************************************************************/ 
-void DESX_Init (DES_CTX *context, unsigned char key[], unsigned char iv[], int encrypt)
+void DESX_Init (DES_CTX *context, unsigned char key[], unsigned char iv[], int encrypt, DESKeyCache *cache)
 {  
   /* Copy encrypt flag to context.
    */
@@ -607,13 +751,34 @@ void DESX_Init (DES_CTX *context, unsigned char key[], unsigned char iv[], int e
 
   /* Precompute key schedule.
    */
-   if(context->desmode == OFBISO || context->desmode == OFBFIPS81 || context->desmode == CFB)
-   		DESKey (context->subkeys[0], key, ENCRYPT);
-   else DESKey (context->subkeys[0], key, context->encrypt);
-   
+   if(context->desmode == OFBISO || context->desmode == OFBFIPS81 || context->desmode == CFB || context->desmode == CTR)
+   		DESScheduleKeys (context, key, ENCRYPT, cache);
+   else DESScheduleKeys (context, key, context->encrypt, cache);
+
+  DESXWhiteners (context);
+}
+
+/* Resolves the whiteners for the direction DESXFunction runs in (the
+   feedback and counter modes always run it forwards) and moves them into
+   the IP domain, where they can be xored straight into the round halves.
+ */
+static void DESXWhiteners (DES_CTX *context)
+{
+  UInt32 work;
+
+  if (context->encrypt || context->desmode == OFBISO || context->desmode == OFBFIPS81 || context->desmode == CFB || context->desmode == CTR) {
+    DES_TO_IP (context->preWhitener, context->inputWhitener, work);
+    DES_TO_IP (context->postWhitener, context->outputWhitener, work);
+  }
+  else {
+    DES_TO_IP (context->preWhitener, context->outputWhitener, work);
+    DES_TO_IP (context->postWhitener, context->inputWhitener, work);
+  }
 }
+#endif
 
 
+#if !defined(DES_NO_DESX) && !defined(DES_NO_ECB)
 /***********************************************************************
  *
  * FUNCTION:    DESX_ECBpdate
@@ -639,34 +804,23 @@ void DESX_Init (DES_CTX *context, unsigned char key[], unsigned char iv[], int e
  ***********************************************************************/
 int DESX_ECBUpdate (DES_CTX *context, unsigned char *output, unsigned char *input, unsigned long len)
 {
-  UInt32 inputBlock[2], work[2];
-  int i;
+  UInt32 work[2];
+  unsigned long i;
   
   if (len % 8)
     return (RE_LEN);
 
-  for (i = 0; i < len/8; i++) {
-    Pack (inputBlock, &input[8*i]);
-  
-  if(context->encrypt==ENCRYPT){      
-  	work[0] = inputBlock[0] ^ context->inputWhitener[0];
-	work[1] = inputBlock[1] ^ context->inputWhitener[1];         
-	}
-  else{
-  	work[0] = inputBlock[0] ^ context->outputWhitener[0];
-	work[1] = inputBlock[1] ^ context->outputWhitener[1];
-  }
-  DESFunction(work, context->subkeys[0]);
-  
-  if(context->encrypt==ENCRYPT){  
-  	work[0] ^=  context->outputWhitener[0];
-  	work[1] ^=  context->outputWhitener[1];
-  	}
-  else{
-  	work[0] ^=  context->inputWhitener[0];
-  	work[1] ^=  context->inputWhitener[1];
-  }
-  Unpack (&output[8*i], work);
+  /* Runs of blocks go through the multi-block kernels, the rest one at a time.
+   */
+  if (context->encrypt==ENCRYPT)
+    i = DESMultiBlock (context, output, input, len/8, context->inputWhitener, context->outputWhitener, 1, NULL);
+  else
+    i = DESMultiBlock (context, output, input, len/8, context->outputWhitener, context->inputWhitener, 1, NULL);
+
+  for (; i < len/8; i++) {
+    Pack (work, &input[8*i]);
+    DESXFunction (context, work);
+    Unpack (&output[8*i], work);
   }
   
   /* Zeroize sensitive information.
@@ -675,7 +829,9 @@ int DESX_ECBUpdate (DES_CTX *context, unsigned char *output, unsigned char *inpu
   */
   return (0);
 }
+#endif
 
+#if !defined(DES_NO_DESX) && !defined(DES_NO_CBC)
  /***********************************************************************
  *
  * FUNCTION:    DESX_CBCUpdate
@@ -707,35 +863,39 @@ int DESX_CBCUpdate (DES_CTX *context, unsigned char *output, unsigned char *inpu
   if (len % 8)
     return (RE_LEN);
 
-  for (i = 0; i < len/8; i++)  {
+  /* Decryption has no chaining dependency between cipher operations, so
+     runs of blocks go through the multi-block kernels, and in DES_THREADS
+     builds large runs through several threads.  Encryption is serial.
+   */
+  i = 0;
+  if (!context->encrypt)
+    i = DESChainRun (context, output, input, len/8, DESX);
+
+  for (; i < len/8; i++)  {
     Pack (inputBlock, &input[8*i]);
         
-    /* Chain if encrypting, and xor with whitener.
+    /* Chain if encrypting.  DESXFunction applies the whiteners.
      */
     if (context->encrypt) {
-      work[0] =
-        inputBlock[0] ^ context->iv[0] ^ context->inputWhitener[0];
-      work[1] =
-        inputBlock[1] ^ context->iv[1] ^ context->inputWhitener[1];
+      work[0] = inputBlock[0] ^ context->iv[0];
+      work[1] = inputBlock[1] ^ context->iv[1];
     }
     else {
-      work[0] = inputBlock[0] ^ context->outputWhitener[0];
-      work[1] = inputBlock[1] ^ context->outputWhitener[1];         
+      work[0] = inputBlock[0];
+      work[1] = inputBlock[1];         
     }
 
-    DESFunction (work, context->subkeys[0]);
+    DESXFunction (context, work);
 
-    /* Xor with whitener, chain if decrypting, then update IV.
+    /* Chain if decrypting, then update IV.
      */
     if (context->encrypt) {
-      work[0] ^= context->outputWhitener[0];
-      work[1] ^= context->outputWhitener[1];
       context->iv[0] = work[0];
       context->iv[1] = work[1];
     }
     else {
-      work[0] ^= context->iv[0] ^ context->inputWhitener[0];
-      work[1] ^= context->iv[1] ^ context->inputWhitener[1];
+      work[0] ^= context->iv[0];
+      work[1] ^= context->iv[1];
       context->iv[0] = inputBlock[0];
       context->iv[1] = inputBlock[1];
     }
@@ -748,14 +908,16 @@ int DESX_CBCUpdate (DES_CTX *context, unsigned char *output, unsigned char *inpu
   */
   return (0);
 }
+#endif
 
+#if !defined(DES_NO_DESX) && !defined(DES_NO_CFB)
 /***********************************************************************
  *
  * FUNCTION:    DESX_CFBUpdate
  *
  * DESCRIPTION: DESX-CFB block update operation. Continues a DESX-CFB encryption
- *  			operation, processing eight-byte message blocks, and updating
- *  			the context.
+ *  			operation, processing n-bit segments, and updating the context.
+ *				len may end inside a segment; the next call resumes it.
  *
  * PARAMETERS: 
  *				DES_CTX *context: 	context 
@@ -774,125 +936,18 @@ int DESX_CBCUpdate (DES_CTX *context, unsigned char *output, unsigned char *inpu
  ***********************************************************************/
 int DESX_CFBUpdate (DES_CTX *context, unsigned char *output, unsigned char *input, unsigned long len)
 {
-  UInt32 inputBlock[2], work[2], outputBlocks[2];
-  int i,j, rounds, maxlen, nbitshift;
-  UInt8 tempBlocks[8];
-  
-  maxlen=len/8;
-  rounds = 64/context->n;
-  nbitshift = context->n;
-  
-  if ((nbitshift == 8) || (nbitshift == 16) || (nbitshift == 32) || (nbitshift == 64) || (nbitshift == 1)){
-    
-  for (i = 0; i < maxlen; i++) {
-   
-    Pack (inputBlock, &input[8*i]);
-    
-    for(j=0;j<8;j++) tempBlocks[j]=0;
-    outputBlocks[0]=0;
-    outputBlocks[1]=0;
-   
-    for(j=0; j < rounds ; j++){    
-   		work[0] = context->iv[0] ^ context->inputWhitener[0];
-   		work[1] = context->iv[1] ^ context->inputWhitener[1];
-			
-	    DESFunction(work, context->subkeys[0]);
-		
-	   	work[0] ^= context->outputWhitener[0];
-   		work[1] ^= context->outputWhitener[1];
-		
-		if(nbitshift==1){
-				if(j<8) tempBlocks[0] =  tempBlocks[0] | (((UInt8) (work[0]>>31) &0x00000001) << (7-j)); 
-				else if (j<16) tempBlocks[1] =  tempBlocks[1] | (((UInt8) (work[0]>>31) &0x00000001) <<(15-j)); 
-				else if (j<24) tempBlocks[2] =  tempBlocks[2] | (((UInt8) (work[0]>>31) &0x00000001) <<(23-j)); 
-				else if (j<32) tempBlocks[3] =  tempBlocks[3] | (((UInt8) (work[0]>>31) &0x00000001) <<(31-j));
-				else if (j<40) tempBlocks[4] =  tempBlocks[4] | (((UInt8) (work[0]>>31) &0x00000001) <<(39-j));
-				else if (j<48) tempBlocks[5] =  tempBlocks[5] | (((UInt8) (work[0]>>31) &0x00000001) <<(47-j));
-				else if (j<56) tempBlocks[6] =  tempBlocks[6] | (((UInt8) (work[0]>>31) &0x00000001) <<(55-j)); 
-				else tempBlocks[7] =  tempBlocks[7] | (((UInt8) (work[0]>>31) &0x00000001) <<(61-j));
-				context->iv[0] = (context->iv[0]<<1)| ((context->iv[1] >> 31) & 0x00000001);
-			   
-				if(context->encrypt==ENCRYPT) 
-			   		context->iv[1] = (context->iv[1]<<1)| (((work[0] >> 31) ^ (inputBlock[j/32]>>(31-(j%32)))) & 0x00000001);
-				else 
-					context->iv[1] = (context->iv[1]<<1)| (inputBlock[j/32]>>(31-(j%32)) & 0x00000001);
-				
-			}
-		else if(nbitshift == 8){  
-				tempBlocks[j]= (UInt8) (work[0]>>24); 
-				context->iv[0] = (context->iv[0]<<8)| ((context->iv[1] >> 24) & 0x000000FF);
-			   	if(context->encrypt==ENCRYPT) 
-			   		context->iv[1] = (context->iv[1]<<8)| (((work[0] >> 24) ^ (inputBlock[j/4]>>(24-(j%4)*8))) & 0x000000FF);
-				else 
-					context->iv[1] = (context->iv[1]<<8)| (inputBlock[j/4]>>(24-(j%4)*8) & 0x000000FF);
-				}
-		else if (nbitshift == 16){
-				tempBlocks[2*j]= (UInt8) (work[0]>>24); 
-				tempBlocks[2*j+1]= (UInt8) ((work[0]>>16)&0x000000FF);
-				
-				context->iv[0] = (context->iv[0]<<16)| ((context->iv[1] >> 16) & 0x0000FFFF);
-			   	context->iv[1] = (context->iv[1]<<16)| ((work[0] >> 16) & 0x0000FFFF);
-			   	if(context->encrypt==ENCRYPT) 
-			   		context->iv[1] = (context->iv[1]<<16)| (((work[0] >> 16) ^ (inputBlock[j/2]>>(16-(j%2)*16))) & 0x0000FFFF);
-				else 
-					context->iv[1] = (context->iv[1]<<16)| (inputBlock[j/2]>>(16-(j%2)*16) & 0x0000FFFF);
-				}
-		else if (nbitshift == 32){
-				tempBlocks[4*j]= (UInt8) 	(work[0]>>24); 
-				tempBlocks[4*j+1]= (UInt8) ((work[0]>>16)&0x000000FF);
-				tempBlocks[4*j+2]= (UInt8) ((work[0]>>8)&0x000000FF); 
-				tempBlocks[4*j+3]= (UInt8) (work[0]&0x000000FF);
-				context->iv[0] = context->iv[1];
-			   	if(context->encrypt==ENCRYPT)
-				   	context->iv[1] = work[0] ^ inputBlock[j%2];
-				else context->iv[1] = inputBlock[j%2];		   	
-			   	}
-		else {
-				tempBlocks[0]= (UInt8) 	(work[0]>>24); 
-				tempBlocks[1]= (UInt8) ((work[0]>>16)&0x000000FF);
-				tempBlocks[2]= (UInt8) ((work[0]>>8)&0x000000FF); 
-				tempBlocks[3]= (UInt8) (work[0]&0x000000FF);
-				tempBlocks[4]= (UInt8) 	(work[1]>>24); 
-				tempBlocks[5]= (UInt8) ((work[1]>>16)&0x000000FF);
-				tempBlocks[6]= (UInt8) ((work[1]>>8)&0x000000FF); 
-				tempBlocks[7]= (UInt8) (work[1]&0x000000FF);
-				if(context->encrypt==ENCRYPT){
-				context->iv[0] = work[0] ^ inputBlock[0];
-			   	context->iv[1] = work[1] ^ inputBlock[1];
-			   	}
-			   	else
-			   	{
-			   	context->iv[0] = inputBlock[0];
-			   	context->iv[1] = inputBlock[1];
-			   	}
-				}
-		}
-   	Pack (outputBlocks, &tempBlocks[0]);
-   	inputBlock[0]^=outputBlocks[0];
-   	inputBlock[1]^=outputBlocks[1];
-    Unpack (&output[8*i], inputBlock);
-
-  
-  }
-  
-  /* Zeroize sensitive information.
-  R_memset ((POINTER)inputBlock, 0, sizeof (inputBlock));
-  R_memset ((POINTER)work, 0, sizeof (work));
-  */
-  return (0);
-  }
-  
-
-  else return RE_LEN;
+  return DESFeedback (context, output, input, len, DESX, CFB);
 }
+#endif
 
+#if !defined(DES_NO_DESX) && !defined(DES_NO_OFB)
 /***********************************************************************
  *
  * FUNCTION:    DESX_OFBISOUpdate
  *
  * DESCRIPTION: DESX-OFB block update operation. Continues a DESX-OFB encryption
- *  			operation.  Note:  If n is not equal to 1, 8, 16, 32, or 64
- *				an error will be returned.
+ *  			operation in n-bit segments, n from 1 to 64.  len may end
+ *				inside a segment; the next call resumes it.
  *
  * PARAMETERS: 
  *				DES_CTX *context: 	context 
@@ -911,92 +966,18 @@ int DESX_CFBUpdate (DES_CTX *context, unsigned char *output, unsigned char *inpu
  ***********************************************************************/
 int DESX_OFBISOUpdate (DES_CTX *context, unsigned char *output, unsigned char *input, unsigned long len)
 {
-  UInt32 inputBlock[2], work[2], outputBlocks[2];
-  int i,j, rounds, maxlen, nbitshift;
-  UInt8 tempBlocks[8];
-  
-  maxlen=len/8;
-  rounds = 64/context->n;
-  nbitshift = context->n;
-  
-  if ((nbitshift == 8) || (nbitshift == 16) || (nbitshift == 32) || (nbitshift == 64) || (nbitshift == 1)){
-    
-  for (i = 0; i < maxlen; i++) {
-   
-    Pack (inputBlock, &input[8*i]);
-    
-    for(j=0;j<8;j++) tempBlocks[j]=0;
-    outputBlocks[0]=0;
-    outputBlocks[1]=0;
-   
-    for(j=0; j < rounds ; j++){    
-   		work[0] = context->iv[0] ^ context->inputWhitener[0];
-   		work[1] = context->iv[1] ^ context->inputWhitener[0];
-			
-	    DESFunction(work, context->subkeys[0]);
-		
-	   	context->iv[0] = work[0] ^ context->outputWhitener[0];
-	   	context->iv[1] = work[1] ^ context->outputWhitener[1];
-		
-		if(nbitshift==1){
-				if(j<8) tempBlocks[0] =  tempBlocks[0] | (((UInt8) (work[0]>>31) &0x00000001) << (7-j)); 
-				else if (j<16) tempBlocks[1] =  tempBlocks[1] | (((UInt8) (work[0]>>31) &0x00000001) <<(15-j)); 
-				else if (j<24) tempBlocks[2] =  tempBlocks[2] | (((UInt8) (work[0]>>31) &0x00000001) <<(23-j)); 
-				else if (j<32) tempBlocks[3] =  tempBlocks[3] | (((UInt8) (work[0]>>31) &0x00000001) <<(31-j));
-				else if (j<40) tempBlocks[4] =  tempBlocks[4] | (((UInt8) (work[0]>>31) &0x00000001) <<(39-j));
-				else if (j<48) tempBlocks[5] =  tempBlocks[5] | (((UInt8) (work[0]>>31) &0x00000001) <<(47-j));
-				else if (j<56) tempBlocks[6] =  tempBlocks[6] | (((UInt8) (work[0]>>31) &0x00000001) <<(55-j)); 
-				else tempBlocks[7] =  tempBlocks[7] | (((UInt8) (work[0]>>31) &0x00000001) <<(61-j));
-			}
-		else if(nbitshift == 8){  
-				tempBlocks[j]= (UInt8) (work[0]>>24); 
-				}
-		else if (nbitshift == 16){
-				tempBlocks[2*j]= (UInt8) (work[0]>>24); 
-				tempBlocks[2*j+1]= (UInt8) ((work[0]>>16)&0x000000FF);
-				}
-		else if (nbitshift == 32){
-				tempBlocks[4*j]= (UInt8) 	(work[0]>>24); 
-				tempBlocks[4*j+1]= (UInt8) ((work[0]>>16)&0x000000FF);
-				tempBlocks[4*j+2]= (UInt8) ((work[0]>>8)&0x000000FF); 
-				tempBlocks[4*j+3]= (UInt8) (work[0]&0x000000FF);
-				}
-		else {
-				tempBlocks[0]= (UInt8) 	(work[0]>>24); 
-				tempBlocks[1]= (UInt8) ((work[0]>>16)&0x000000FF);
-				tempBlocks[2]= (UInt8) ((work[0]>>8)&0x000000FF); 
-				tempBlocks[3]= (UInt8) (work[0]&0x000000FF);
-				tempBlocks[4]= (UInt8) 	(work[1]>>24); 
-				tempBlocks[5]= (UInt8) ((work[1]>>16)&0x000000FF);
-				tempBlocks[6]= (UInt8) ((work[1]>>8)&0x000000FF); 
-				tempBlocks[7]= (UInt8) (work[1]&0x000000FF);
-				}
-		}
-   	Pack (outputBlocks, &tempBlocks[0]);
-   	inputBlock[0]^=outputBlocks[0] ^ context->outputWhitener[0];;
-   	inputBlock[1]^=outputBlocks[1] ^ context->outputWhitener[1];;
-    Unpack (&output[8*i], inputBlock);
-  
-  }
-  
-  /* Zeroize sensitive information.
-  R_memset ((POINTER)inputBlock, 0, sizeof (inputBlock));
-  R_memset ((POINTER)work, 0, sizeof (work));
-  */
-  return (0);
-  }
-  
-
-  else return RE_LEN;
+  return DESFeedback (context, output, input, len, DESX, OFBISO);
 }
+#endif
 
+#if !defined(DES_NO_DESX) && !defined(DES_NO_OFB)
 /***********************************************************************
  *
  * FUNCTION:    DES_OFBFIPS81Update
  *
  * DESCRIPTION: DES-OFB block update operation. Continues a DES-OFB encryption
- *  			operation.  Note:  If n is not equal to 1, 8, 16, 32, or 64
- *				an error will be returned.
+ *  			operation in n-bit segments, n from 1 to 64.  len may end
+ *				inside a segment; the next call resumes it.
  *
  * PARAMETERS: 
  *				DES_CTX *context: 	context 
@@ -1015,95 +996,40 @@ int DESX_OFBISOUpdate (DES_CTX *context, unsigned char *output, unsigned char *i
  ***********************************************************************/
 int DESX_OFBFIPS81Update (DES_CTX *context, unsigned char *output, unsigned char *input, unsigned long len)
 {
-  UInt32 inputBlock[2], work[2], outputBlocks[2];
-  int i,j, rounds, maxlen, nbitshift;
-  UInt8 tempBlocks[8];
-  
-  maxlen=len/8;
-  rounds = 64/context->n;
-  nbitshift = context->n;
-  
-  if ((nbitshift == 8) || (nbitshift == 16) || (nbitshift == 32) || (nbitshift == 64) || (nbitshift == 1)){
-    
-  for (i = 0; i < maxlen; i++) {
-   
-    Pack (inputBlock, &input[8*i]);
-    
-    for(j=0;j<8;j++) tempBlocks[j]=0;
-    outputBlocks[0]=0;
-    outputBlocks[1]=0;
-   
-    for(j=0; j < rounds ; j++){    
-   		work[0] = context->iv[0] ^ context->inputWhitener[0];
-   		work[1] = context->iv[1] ^ context->inputWhitener[1];
-			
-	    DESFunction(work, context->subkeys[0]);
-		
-	   	work[0] ^= context->outputWhitener[0];
-		work[1] ^= context->outputWhitener[1];
-		
-		if(nbitshift==1){
-				if(j<8) tempBlocks[0] =  tempBlocks[0] | (((UInt8) (work[0]>>31) &0x00000001) << (7-j)); 
-				else if (j<16) tempBlocks[1] =  tempBlocks[1] | (((UInt8) (work[0]>>31) &0x00000001) <<(15-j)); 
-				else if (j<24) tempBlocks[2] =  tempBlocks[2] | (((UInt8) (work[0]>>31) &0x00000001) <<(23-j)); 
-				else if (j<32) tempBlocks[3] =  tempBlocks[3] | (((UInt8) (work[0]>>31) &0x00000001) <<(31-j));
-				else if (j<40) tempBlocks[4] =  tempBlocks[4] | (((UInt8) (work[0]>>31) &0x00000001) <<(39-j));
-				else if (j<48) tempBlocks[5] =  tempBlocks[5] | (((UInt8) (work[0]>>31) &0x00000001) <<(47-j));
-				else if (j<56) tempBlocks[6] =  tempBlocks[6] | (((UInt8) (work[0]>>31) &0x00000001) <<(55-j)); 
-				else tempBlocks[7] =  tempBlocks[7] | (((UInt8) (work[0]>>31) &0x00000001) <<(61-j));
-				context->iv[0] = (context->iv[0]<<1)| ((context->iv[1] >> 31) & 0x00000001);
-			   	context->iv[1] = (context->iv[1]<<1)| ((work[0] >> 31) & 0x00000001);
-			}
-		else if(nbitshift == 8){  
-				tempBlocks[j]= (UInt8) (work[0]>>24); 
-				context->iv[0] = (context->iv[0]<<8)| ((context->iv[1] >> 24) & 0x000000FF);
-			   	context->iv[1] = (context->iv[1]<<8)| ((work[0] >> 24) & 0x000000FF);
-				}
-		else if (nbitshift == 16){
-				tempBlocks[2*j]= (UInt8) (work[0]>>24); 
-				tempBlocks[2*j+1]= (UInt8) ((work[0]>>16)&0x000000FF);
-				context->iv[0] = (context->iv[0]<<16)| ((context->iv[1] >> 16) & 0x0000FFFF);
-			   	context->iv[1] = (context->iv[1]<<16)| ((work[0] >> 16) & 0x0000FFFF);
-				}
-		else if (nbitshift == 32){
-				tempBlocks[4*j]= (UInt8) 	(work[0]>>24); 
-				tempBlocks[4*j+1]= (UInt8) ((work[0]>>16)&0x000000FF);
-				tempBlocks[4*j+2]= (UInt8) ((work[0]>>8)&0x000000FF); 
-				tempBlocks[4*j+3]= (UInt8) (work[0]&0x000000FF);
-				context->iv[0] = context->iv[1];
-			   	context->iv[1] = work[0];
-				}
-		else {
-				tempBlocks[0]= (UInt8) 	(work[0]>>24); 
-				tempBlocks[1]= (UInt8) ((work[0]>>16)&0x000000FF);
-				tempBlocks[2]= (UInt8) ((work[0]>>8)&0x000000FF); 
-				tempBlocks[3]= (UInt8) (work[0]&0x000000FF);
-				tempBlocks[4]= (UInt8) 	(work[1]>>24); 
-				tempBlocks[5]= (UInt8) ((work[1]>>16)&0x000000FF);
-				tempBlocks[6]= (UInt8) ((work[1]>>8)&0x000000FF); 
-				tempBlocks[7]= (UInt8) (work[1]&0x000000FF);
-				context->iv[0] = work[0];
-			   	context->iv[1] = work[1];
-				}
-		}
-   	Pack (outputBlocks, &tempBlocks[0]);
-   	inputBlock[0]^=outputBlocks[0];
-   	inputBlock[1]^=outputBlocks[1];
-    Unpack (&output[8*i], inputBlock);
-
-  
-  }
-  
-  /* Zeroize sensitive information.
-  R_memset ((POINTER)inputBlock, 0, sizeof (inputBlock));
-  R_memset ((POINTER)work, 0, sizeof (work));
-  */
-  return (0);
-  }
-  
+  return DESFeedback (context, output, input, len, DESX, OFBFIPS81);
+}
+#endif
 
-  else return RE_LEN;
+#if !defined(DES_NO_DESX) && !defined(DES_NO_CTR)
+/***********************************************************************
+ *
+ * FUNCTION:    DESX_CTRUpdate
+ *
+ * DESCRIPTION: DESX-CTR block update operation. Continues a DESX-CTR encryption
+ *  			or decryption, one keystream block per counter value.  len
+ *				may end inside a block; the next call resumes it.
+ *
+ * PARAMETERS: 
+ *				DES_CTX *context: 	context 
+ *				unsigned char *output: 	output block 
+ *				unsigned char *input: 	input block 
+ *				unsigned int len: 		length of input and output blocks 
+ *
+ *
+ * RETURNED:    nothing
+ *
+ * REVISION HISTORY:
+ *			Name	Date		Description
+ *			----	----		-----------
+ *			
+ *
+ ***********************************************************************/
+int DESX_CTRUpdate (DES_CTX *context, unsigned char *output, unsigned char *input, unsigned long len)
+{
+  return DESCounter (context, output, input, len, DESX);
 }
+#endif
+#ifndef DES_NO_DESX
 /***********************************************************************
  *
  * FUNCTION:    DESX_CBCRestart
@@ -1127,8 +1053,13 @@ void DESX_Restart (DES_CTX *context)
   /* Reset to the original IV */
   context->iv[0] = context->originalIV[0];
   context->iv[1] = context->originalIV[1];
+  context->keystreamUsed = 0;
+  context->blockBits = 0;
+  context->aheadCount = 0;
 }
+#endif
 
+#ifndef DES_NO_DES3
 /***********************************************************************
  *
  * FUNCTION:    DES3_CBCInit
@@ -1150,7 +1081,7 @@ void DESX_Restart (DES_CTX *context)
  *			
  *
  ***********************************************************************/ 
-void DES3_Init(DES_CTX *context, unsigned char key[], unsigned char iv[], int encrypt)
+void DES3_Init(DES_CTX *context, unsigned char key[], unsigned char iv[], int encrypt, DESKeyCache *cache)
 {  
   /* Copy encrypt flag to context.
    */
@@ -1166,18 +1097,17 @@ void DES3_Init(DES_CTX *context, unsigned char key[], unsigned char iv[], int en
 
   /* Precompute key schedules.
    */
-  if((context->desmode == OFBISO) || (context->desmode == CFB)|| (context->desmode == OFBFIPS81)){
-    DESKey (context->subkeys[0], encrypt ? key : &key[16], ENCRYPT);
-  	DESKey (context->subkeys[1], &key[8], DECRYPT);
-  	DESKey (context->subkeys[2], encrypt ? &key[16] : key, ENCRYPT);
-  }
-  else{
-  DESKey (context->subkeys[0], encrypt ? key : &key[16], encrypt);
-  DESKey (context->subkeys[1], &key[8], !encrypt);
-  DESKey (context->subkeys[2], encrypt ? &key[16] : key, encrypt);
-  }
+  /* The feedback and counter modes run the cipher forwards in both
+     directions, so both sides need the same E-D-E schedule.
+   */
+  if((context->desmode == OFBISO) || (context->desmode == CFB)|| (context->desmode == OFBFIPS81) || (context->desmode == CTR))
+    DESScheduleKeys (context, key, ENCRYPT, cache);
+  else
+    DESScheduleKeys (context, key, encrypt, cache);
 }
+#endif
 
+#if !defined(DES_NO_DES3) && !defined(DES_NO_ECB)
 /***********************************************************************
  *
  * FUNCTION:    DES3_ECBUpdate
@@ -1204,20 +1134,22 @@ void DES3_Init(DES_CTX *context, unsigned char key[], unsigned char iv[], int en
  int DES3_ECBUpdate (DES_CTX *context, unsigned char *output, unsigned char *input, unsigned long len)
 {
   UInt32 inputBlock[2], work[2];
-  int i;
+  unsigned long i;
   
   if (len % 8)
     return (RE_LEN);
 
-  for (i = 0; i < len/8; i++) {
+  /* Runs of blocks go through the multi-block kernels, the rest one at a time.
+   */
+  i = DESMultiBlock (context, output, input, len/8, NULL, NULL, 3, NULL);
+
+  for (; i < len/8; i++) {
     Pack (inputBlock, &input[8*i]);
         
   work[0] = inputBlock[0];
   work[1] = inputBlock[1];         
 
-  DESFunction (work, context->subkeys[0]);
-  DESFunction (work, context->subkeys[1]);
-  DESFunction (work, context->subkeys[2]);
+  DES3_FUNCTION (context, work, context->subkeys);
 
   Unpack (&output[8*i], work);
   }
@@ -1228,8 +1160,10 @@ void DES3_Init(DES_CTX *context, unsigned char key[], unsigned char iv[], int en
   */
   return (0);
 }
+#endif
 
 
+#if !defined(DES_NO_DES3) && !defined(DES_NO_CBC)
 /***********************************************************************
  *
  * FUNCTION:    DES3_CBCUpdate
@@ -1261,7 +1195,15 @@ int DES3_CBCUpdate (DES_CTX *context, unsigned char *output, unsigned char *inpu
   if (len % 8)
     return (RE_LEN);
 
-  for (i = 0; i < len/8; i++) {
+  /* Decryption has no chaining dependency between cipher operations, so
+     runs of blocks go through the multi-block kernels, and in DES_THREADS
+     builds large runs through several threads.  Encryption is serial.
+   */
+  i = 0;
+  if (!context->encrypt)
+    i = DESChainRun (context, output, input, len/8, DES3);
+
+  for (; i < len/8; i++) {
     Pack (inputBlock, &input[8*i]);
         
     /* Chain if encrypting.
@@ -1275,9 +1217,7 @@ int DES3_CBCUpdate (DES_CTX *context, unsigned char *output, unsigned char *inpu
       work[1] = inputBlock[1];         
     }
 
-    DESFunction (work, context->subkeys[0]);
-    DESFunction (work, context->subkeys[1]);
-    DESFunction (work, context->subkeys[2]);
+    DES3_FUNCTION (context, work, context->subkeys);
 
     /* Chain if decrypting, then update IV.
      */
@@ -1300,13 +1240,15 @@ int DES3_CBCUpdate (DES_CTX *context, unsigned char *output, unsigned char *inpu
   */
   return (0);
 }
+#endif
+#if !defined(DES_NO_DES3) && !defined(DES_NO_CFB)
 /***********************************************************************
  *
  * FUNCTION:    DES3_CFBUpdate
  *
  * DESCRIPTION: DES3-CFB block update operation. Continues a 3DES-CFB encryption
- *  			operation, processing eight-byte message blocks, and updating
- *  			the context.
+ *  			operation, processing n-bit segments, and updating the context.
+ *				len may end inside a segment; the next call resumes it.
  *
  * PARAMETERS: 
  *				DES_CTX *context: 	context 
@@ -1325,127 +1267,19 @@ int DES3_CBCUpdate (DES_CTX *context, unsigned char *output, unsigned char *inpu
  ***********************************************************************/
 int DES3_CFBUpdate (DES_CTX *context, unsigned char *output, unsigned char *input, unsigned long len)
 {
-  UInt32 inputBlock[2], work[2], outputBlocks[2];
-  int i,j, rounds, maxlen, nbitshift;
-  UInt8 tempBlocks[8];
-  
-  maxlen=len/8;
-  rounds = 64/context->n;
-  nbitshift = context->n;
-  
-  if ((nbitshift == 8) || (nbitshift == 16) || (nbitshift == 32) || (nbitshift == 64) || (nbitshift == 1)){
-    
-  for (i = 0; i < maxlen; i++) {
-   
-    Pack (inputBlock, &input[8*i]);
-    
-    for(j=0;j<8;j++) tempBlocks[j]=0;
-    outputBlocks[0]=0;
-    outputBlocks[1]=0;
-   
-    for(j=0; j < rounds ; j++){    
-   		work[0] = context->iv[0];
-   		work[1] = context->iv[1];
-			
-	    DESFunction(work, context->subkeys[0]);
-	    DESFunction(work, context->subkeys[1]);
-	    DESFunction(work, context->subkeys[2]);
-		
-	   	
-		
-		if(nbitshift==1){
-				if(j<8) tempBlocks[0] =  tempBlocks[0] | (((UInt8) (work[0]>>31) &0x00000001) << (7-j)); 
-				else if (j<16) tempBlocks[1] =  tempBlocks[1] | (((UInt8) (work[0]>>31) &0x00000001) <<(15-j)); 
-				else if (j<24) tempBlocks[2] =  tempBlocks[2] | (((UInt8) (work[0]>>31) &0x00000001) <<(23-j)); 
-				else if (j<32) tempBlocks[3] =  tempBlocks[3] | (((UInt8) (work[0]>>31) &0x00000001) <<(31-j));
-				else if (j<40) tempBlocks[4] =  tempBlocks[4] | (((UInt8) (work[0]>>31) &0x00000001) <<(39-j));
-				else if (j<48) tempBlocks[5] =  tempBlocks[5] | (((UInt8) (work[0]>>31) &0x00000001) <<(47-j));
-				else if (j<56) tempBlocks[6] =  tempBlocks[6] | (((UInt8) (work[0]>>31) &0x00000001) <<(55-j)); 
-				else tempBlocks[7] =  tempBlocks[7] | (((UInt8) (work[0]>>31) &0x00000001) <<(61-j));
-				context->iv[0] = (context->iv[0]<<1)| ((context->iv[1] >> 31) & 0x00000001);
-			   
-				if(context->encrypt==ENCRYPT) 
-			   		context->iv[1] = (context->iv[1]<<1)| (((work[0] >> 31) ^ (inputBlock[j/32]>>(31-(j%32)))) & 0x00000001);
-				else 
-					context->iv[1] = (context->iv[1]<<1)| (inputBlock[j/32]>>(31-(j%32)) & 0x00000001);
-				
-			}
-		else if(nbitshift == 8){  
-				tempBlocks[j]= (UInt8) (work[0]>>24); 
-				context->iv[0] = (context->iv[0]<<8)| ((context->iv[1] >> 24) & 0x000000FF);
-			   	if(context->encrypt==ENCRYPT) 
-			   		context->iv[1] = (context->iv[1]<<8)| (((work[0] >> 24) ^ (inputBlock[j/4]>>(24-(j%4)*8))) & 0x000000FF);
-				else 
-					context->iv[1] = (context->iv[1]<<8)| (inputBlock[j/4]>>(24-(j%4)*8) & 0x000000FF);
-				}
-		else if (nbitshift == 16){
-				tempBlocks[2*j]= (UInt8) (work[0]>>24); 
-				tempBlocks[2*j+1]= (UInt8) ((work[0]>>16)&0x000000FF);
-				
-				context->iv[0] = (context->iv[0]<<16)| ((context->iv[1] >> 16) & 0x0000FFFF);
-			   	context->iv[1] = (context->iv[1]<<16)| ((work[0] >> 16) & 0x0000FFFF);
-			   	if(context->encrypt==ENCRYPT) 
-			   		context->iv[1] = (context->iv[1]<<16)| (((work[0] >> 16) ^ (inputBlock[j/2]>>(16-(j%2)*16))) & 0x0000FFFF);
-				else 
-					context->iv[1] = (context->iv[1]<<16)| (inputBlock[j/2]>>(16-(j%2)*16) & 0x0000FFFF);
-				}
-		else if (nbitshift == 32){
-				tempBlocks[4*j]= (UInt8) 	(work[0]>>24); 
-				tempBlocks[4*j+1]= (UInt8) ((work[0]>>16)&0x000000FF);
-				tempBlocks[4*j+2]= (UInt8) ((work[0]>>8)&0x000000FF); 
-				tempBlocks[4*j+3]= (UInt8) (work[0]&0x000000FF);
-				context->iv[0] = context->iv[1];
-			   	if(context->encrypt==ENCRYPT)
-				   	context->iv[1] = work[0] ^ inputBlock[j%2];
-				else context->iv[1] = inputBlock[j%2];		   	
-			   	}
-		else {
-				tempBlocks[0]= (UInt8) 	(work[0]>>24); 
-				tempBlocks[1]= (UInt8) ((work[0]>>16)&0x000000FF);
-				tempBlocks[2]= (UInt8) ((work[0]>>8)&0x000000FF); 
-				tempBlocks[3]= (UInt8) (work[0]&0x000000FF);
-				tempBlocks[4]= (UInt8) 	(work[1]>>24); 
-				tempBlocks[5]= (UInt8) ((work[1]>>16)&0x000000FF);
-				tempBlocks[6]= (UInt8) ((work[1]>>8)&0x000000FF); 
-				tempBlocks[7]= (UInt8) (work[1]&0x000000FF);
-				if(context->encrypt==ENCRYPT){
-				context->iv[0] = work[0] ^ inputBlock[0];
-			   	context->iv[1] = work[1] ^ inputBlock[1];
-			   	}
-			   	else
-			   	{
-			   	context->iv[0] = inputBlock[0];
-			   	context->iv[1] = inputBlock[1];
-			   	}
-				}
-		}
-   	Pack (outputBlocks, &tempBlocks[0]);
-   	inputBlock[0]^=outputBlocks[0];
-   	inputBlock[1]^=outputBlocks[1];
-    Unpack (&output[8*i], inputBlock);
-
-  
-  }
-  
-  /* Zeroize sensitive information.
-  R_memset ((POINTER)inputBlock, 0, sizeof (inputBlock));
-  R_memset ((POINTER)work, 0, sizeof (work));
-  */
-  return (0);
-  }
-  
-
-  else return RE_LEN;
+  return DESFeedback (context, output, input, len, DES3, CFB);
 }
+#endif
 
 
+#if !defined(DES_NO_DES3) && !defined(DES_NO_OFB)
 /***********************************************************************
  *
  * FUNCTION:    DES3_OFBISOUpdate
  *
  * DESCRIPTION: 3DES-OFB block update operation. Continues a 3DES-OFB encryption
- *  			operation.  Note:  If n is not equal to 1, 8, 16, 32, or 64
- *				an error will be returned.
+ *  			operation in n-bit segments, n from 1 to 64.  len may end
+ *				inside a segment; the next call resumes it.
  *
  * PARAMETERS: 
  *				DES_CTX *context: 	context 
@@ -1464,95 +1298,19 @@ int DES3_CFBUpdate (DES_CTX *context, unsigned char *output, unsigned char *inpu
  ***********************************************************************/
 int DES3_OFBISOUpdate (DES_CTX *context, unsigned char *output, unsigned char *input, unsigned long len)
 {
-  UInt32 inputBlock[2], work[2], outputBlocks[2];
-  int i,j, rounds, maxlen, nbitshift;
-  UInt8 tempBlocks[8];
-  
-  maxlen=len/8;
-  rounds = 64/context->n;
-  nbitshift = context->n;
-  
-  if ((nbitshift == 8) || (nbitshift == 16) || (nbitshift == 32) || (nbitshift == 64) || (nbitshift == 1)){
-    
-  for (i = 0; i < maxlen; i++) {
-   
-    Pack (inputBlock, &input[8*i]);
-    
-    for(j=0;j<8;j++) tempBlocks[j]=0;
-    outputBlocks[0]=0;
-    outputBlocks[1]=0;
-   
-    for(j=0; j < rounds ; j++){    
-   		work[0] = context->iv[0];
-   		work[1] = context->iv[1];
-			
-	    DESFunction(work, context->subkeys[0]);
-	    DESFunction(work, context->subkeys[1]);
-	    DESFunction(work, context->subkeys[2]);
-		
-	   	context->iv[0] = work[0];
-	   	context->iv[1] = work[1];
-		
-		if(nbitshift==1){
-				if(j<8) tempBlocks[0] =  tempBlocks[0] | (((UInt8) (work[0]>>31) &0x00000001) << (7-j)); 
-				else if (j<16) tempBlocks[1] =  tempBlocks[1] | (((UInt8) (work[0]>>31) &0x00000001) <<(15-j)); 
-				else if (j<24) tempBlocks[2] =  tempBlocks[2] | (((UInt8) (work[0]>>31) &0x00000001) <<(23-j)); 
-				else if (j<32) tempBlocks[3] =  tempBlocks[3] | (((UInt8) (work[0]>>31) &0x00000001) <<(31-j));
-				else if (j<40) tempBlocks[4] =  tempBlocks[4] | (((UInt8) (work[0]>>31) &0x00000001) <<(39-j));
-				else if (j<48) tempBlocks[5] =  tempBlocks[5] | (((UInt8) (work[0]>>31) &0x00000001) <<(47-j));
-				else if (j<56) tempBlocks[6] =  tempBlocks[6] | (((UInt8) (work[0]>>31) &0x00000001) <<(55-j)); 
-				else tempBlocks[7] =  tempBlocks[7] | (((UInt8) (work[0]>>31) &0x00000001) <<(61-j));
-			}
-		else if(nbitshift == 8){  
-				tempBlocks[j]= (UInt8) (work[0]>>24); 
-				}
-		else if (nbitshift == 16){
-				tempBlocks[2*j]= (UInt8) (work[0]>>24); 
-				tempBlocks[2*j+1]= (UInt8) ((work[0]>>16)&0x000000FF);
-				}
-		else if (nbitshift == 32){
-				tempBlocks[4*j]= (UInt8) 	(work[0]>>24); 
-				tempBlocks[4*j+1]= (UInt8) ((work[0]>>16)&0x000000FF);
-				tempBlocks[4*j+2]= (UInt8) ((work[0]>>8)&0x000000FF); 
-				tempBlocks[4*j+3]= (UInt8) (work[0]&0x000000FF);
-				}
-		else {
-				tempBlocks[0]= (UInt8) 	(work[0]>>24); 
-				tempBlocks[1]= (UInt8) ((work[0]>>16)&0x000000FF);
-				tempBlocks[2]= (UInt8) ((work[0]>>8)&0x000000FF); 
-				tempBlocks[3]= (UInt8) (work[0]&0x000000FF);
-				tempBlocks[4]= (UInt8) 	(work[1]>>24); 
-				tempBlocks[5]= (UInt8) ((work[1]>>16)&0x000000FF);
-				tempBlocks[6]= (UInt8) ((work[1]>>8)&0x000000FF); 
-				tempBlocks[7]= (UInt8) (work[1]&0x000000FF);
-				}
-		}
-   	Pack (outputBlocks, &tempBlocks[0]);
-   	inputBlock[0]^=outputBlocks[0];
-   	inputBlock[1]^=outputBlocks[1];
-    Unpack (&output[8*i], inputBlock);
-  
-  }
-  
-  /* Zeroize sensitive information.
-  R_memset ((POINTER)inputBlock, 0, sizeof (inputBlock));
-  R_memset ((POINTER)work, 0, sizeof (work));
-  */
-  return (0);
-  }
-  
-
-  else return RE_LEN;
+  return DESFeedback (context, output, input, len, DES3, OFBISO);
 }
+#endif
 
+#if !defined(DES_NO_DES3) && !defined(DES_NO_OFB)
 /***********************************************************************
  *
  * FUNCTION:    DES3_OFBFIPS81Update
  *
  * DESCRIPTION: 	DES3_OFB block update operation. Continues a DES3-OFB encryption
- *  				operation, processing eight-byte message blocks, and updating
- *  				the context.  Note it only works with 1, 8, 16, 32 and 64 bit
- *					blocks.
+ *  				operation in n-bit segments, n from 1 to 64, and updating
+ *  				the context.  len may end inside a segment; the next call
+ *					resumes it.
  *
  * PARAMETERS:
  *				DES3_CTX *context:	context 
@@ -1571,96 +1329,40 @@ int DES3_OFBISOUpdate (DES_CTX *context, unsigned char *output, unsigned char *i
  ***********************************************************************/ 
 int DES3_OFBFIPS81Update (DES_CTX *context, unsigned char *output, unsigned char *input, unsigned long len)
 {
-  UInt32 inputBlock[2], work[2], outputBlocks[2];
-  int i,j, rounds, maxlen, nbitshift;
-  UInt8 tempBlocks[8];
-  
-  maxlen=len/8;
-  rounds = 64/context->n;
-  nbitshift = context->n;
-  
-  if ((nbitshift == 8) || (nbitshift == 16) || (nbitshift == 32) || (nbitshift == 64) || (nbitshift == 1)){
-    
-  for (i = 0; i < maxlen; i++) {
-   
-    Pack (inputBlock, &input[8*i]);
-    
-    for(j=0;j<8;j++) tempBlocks[j]=0;
-    outputBlocks[0]=0;
-    outputBlocks[1]=0;
-   
-    for(j=0; j < rounds ; j++){    
-   		work[0] = context->iv[0];
-   		work[1] = context->iv[1];
-			
-	    DESFunction (work, context->subkeys[0]);
-	    DESFunction (work, context->subkeys[1]);
-	    DESFunction (work, context->subkeys[2]);
-		
-	   	
-		
-		if(nbitshift==1){
-				if(j<8) tempBlocks[0] =  tempBlocks[0] | (((UInt8) (work[0]>>31) &0x00000001) << (7-j)); 
-				else if (j<16) tempBlocks[1] =  tempBlocks[1] | (((UInt8) (work[0]>>31) &0x00000001) <<(15-j)); 
-				else if (j<24) tempBlocks[2] =  tempBlocks[2] | (((UInt8) (work[0]>>31) &0x00000001) <<(23-j)); 
-				else if (j<32) tempBlocks[3] =  tempBlocks[3] | (((UInt8) (work[0]>>31) &0x00000001) <<(31-j));
-				else if (j<40) tempBlocks[4] =  tempBlocks[4] | (((UInt8) (work[0]>>31) &0x00000001) <<(39-j));
-				else if (j<48) tempBlocks[5] =  tempBlocks[5] | (((UInt8) (work[0]>>31) &0x00000001) <<(47-j));
-				else if (j<56) tempBlocks[6] =  tempBlocks[6] | (((UInt8) (work[0]>>31) &0x00000001) <<(55-j)); 
-				else tempBlocks[7] =  tempBlocks[7] | (((UInt8) (work[0]>>31) &0x00000001) <<(61-j));
-				context->iv[0] = (context->iv[0]<<1)| ((context->iv[1] >> 31) & 0x00000001);
-			   	context->iv[1] = (context->iv[1]<<1)| ((work[0] >> 31) & 0x00000001);
-			}
-		else if(nbitshift == 8){  
-				tempBlocks[j]= (UInt8) (work[0]>>24); 
-				context->iv[0] = (context->iv[0]<<8)| ((context->iv[1] >> 24) & 0x000000FF);
-			   	context->iv[1] = (context->iv[1]<<8)| ((work[0] >> 24) & 0x000000FF);
-				}
-		else if (nbitshift == 16){
-				tempBlocks[2*j]= (UInt8) (work[0]>>24); 
-				tempBlocks[2*j+1]= (UInt8) ((work[0]>>16)&0x000000FF);
-				context->iv[0] = (context->iv[0]<<16)| ((context->iv[1] >> 16) & 0x0000FFFF);
-			   	context->iv[1] = (context->iv[1]<<16)| ((work[0] >> 16) & 0x0000FFFF);
-				}
-		else if (nbitshift == 32){
-				tempBlocks[4*j]= (UInt8) 	(work[0]>>24); 
-				tempBlocks[4*j+1]= (UInt8) ((work[0]>>16)&0x000000FF);
-				tempBlocks[4*j+2]= (UInt8) ((work[0]>>8)&0x000000FF); 
-				tempBlocks[4*j+3]= (UInt8) (work[0]&0x000000FF);
-				context->iv[0] = context->iv[1];
-			   	context->iv[1] = work[0];
-				}
-		else {
-				tempBlocks[0]= (UInt8) 	(work[0]>>24); 
-				tempBlocks[1]= (UInt8) ((work[0]>>16)&0x000000FF);
-				tempBlocks[2]= (UInt8) ((work[0]>>8)&0x000000FF); 
-				tempBlocks[3]= (UInt8) (work[0]&0x000000FF);
-				tempBlocks[4]= (UInt8) 	(work[1]>>24); 
-				tempBlocks[5]= (UInt8) ((work[1]>>16)&0x000000FF);
-				tempBlocks[6]= (UInt8) ((work[1]>>8)&0x000000FF); 
-				tempBlocks[7]= (UInt8) (work[1]&0x000000FF);
-				context->iv[0] = work[0];
-			   	context->iv[1] = work[1];
-				}
-		}
-   	Pack (outputBlocks, &tempBlocks[0]);
-   	inputBlock[0]^=outputBlocks[0];
-   	inputBlock[1]^=outputBlocks[1];
-    Unpack (&output[8*i], inputBlock);
-
-  
-  }
-  
-  /* Zeroize sensitive information.
-  R_memset ((POINTER)inputBlock, 0, sizeof (inputBlock));
-  R_memset ((POINTER)work, 0, sizeof (work));
-  */
-  return (0);
-  }
-  
+  return DESFeedback (context, output, input, len, DES3, OFBFIPS81);
+}
+#endif
 
-  else return RE_LEN;
+#if !defined(DES_NO_DES3) && !defined(DES_NO_CTR)
+/***********************************************************************
+ *
+ * FUNCTION:    DES3_CTRUpdate
+ *
+ * DESCRIPTION: DES3-CTR block update operation. Continues a DES3-CTR encryption
+ *  			or decryption, one keystream block per counter value.  len
+ *				may end inside a block; the next call resumes it.
+ *
+ * PARAMETERS: 
+ *				DES_CTX *context: 	context 
+ *				unsigned char *output: 	output block 
+ *				unsigned char *input: 	input block 
+ *				unsigned int len: 		length of input and output blocks 
+ *
+ *
+ * RETURNED:    nothing
+ *
+ * REVISION HISTORY:
+ *			Name	Date		Description
+ *			----	----		-----------
+ *			
+ *
+ ***********************************************************************/
+int DES3_CTRUpdate (DES_CTX *context, unsigned char *output, unsigned char *input, unsigned long len)
+{
+  return DESCounter (context, output, input, len, DES3);
 }
+#endif
+#ifndef DES_NO_DES3
 /***********************************************************************
  *
  * FUNCTION:    DES3_CBCRestart
@@ -1684,7 +1386,11 @@ void DES3_Restart (DES_CTX *context)
   /* Reset to the original IV */
   context->iv[0] = context->originalIV[0];
   context->iv[1] = context->originalIV[1];
+  context->keystreamUsed = 0;
+  context->blockBits = 0;
+  context->aheadCount = 0;
 }
+#endif
 
 /***********************************************************************
  *
@@ -1705,6 +1411,72 @@ void DES3_Restart (DES_CTX *context)
  *			
  *
  ***********************************************************************/
+#ifdef DES_PACK64
+static void Pack (UInt32 *into, unsigned char *outof)
+{
+  unsigned long long block;
+
+  __builtin_memcpy (&block, outof, 8);
+  block = DES_BIG_ENDIAN64 (block);
+  into[0] = (UInt32)(block >> 32);
+  into[1] = (UInt32)block;
+}
+
+static void Unpack (unsigned char *into, UInt32 *outof)
+{
+  unsigned long long block;
+
+  block = ((unsigned long long)outof[0] << 32) | outof[1];
+  block = DES_BIG_ENDIAN64 (block);
+  __builtin_memcpy (into, &block, 8);
+}
+
+/* Pack and Unpack over count consecutive blocks.  The loops have no
+   dependencies between blocks, so compilers turn them into vector byte
+   shuffles where the target has them.
+ */
+static void PackBlocks (UInt32 *into, unsigned char *outof, int count)
+{
+  unsigned long long block;
+  int i;
+
+  for (i = 0; i < count; i++) {
+    __builtin_memcpy (&block, &outof[8*i], 8);
+    block = DES_BIG_ENDIAN64 (block);
+    into[2*i] = (UInt32)(block >> 32);
+    into[2*i+1] = (UInt32)block;
+  }
+}
+
+static void UnpackBlocks (unsigned char *into, UInt32 *outof, int count)
+{
+  unsigned long long block;
+  int i;
+
+  for (i = 0; i < count; i++) {
+    block = ((unsigned long long)outof[2*i] << 32) | outof[2*i+1];
+    block = DES_BIG_ENDIAN64 (block);
+    __builtin_memcpy (&into[8*i], &block, 8);
+  }
+}
+
+#ifdef DES_STREAM_STORES
+/* UnpackBlocks with non-temporal stores; the caller fences once the
+   whole buffer is written.
+ */
+static void UnpackBlocksStream (unsigned char *into, UInt32 *outof, int count)
+{
+  unsigned long long block;
+  int i;
+
+  for (i = 0; i < count; i++) {
+    block = ((unsigned long long)outof[2*i] << 32) | outof[2*i+1];
+    block = DES_BIG_ENDIAN64 (block);
+    _mm_stream_si64 ((long long *)&into[8*i], (long long)block);
+  }
+}
+#endif
+#else
 static void Pack (UInt32 *into, unsigned char *outof)
 {
   *into    = (*outof++ & 0xffL) << 24;
@@ -1729,37 +1501,114 @@ static void Unpack (unsigned char *into, UInt32 *outof)
   *into   = (unsigned char)( *outof        & 0xffL);
 }
 
-static void DESKey (UInt32 subkeys[], unsigned char key[], int encrypt)
+#ifndef DES_MINIMAL
+static void PackBlocks (UInt32 *into, unsigned char *outof, int count)
+{
+  int i;
+
+  for (i = 0; i < count; i++)
+    Pack (&into[2*i], &outof[8*i]);
+}
+
+static void UnpackBlocks (unsigned char *into, UInt32 *outof, int count)
+{
+  int i;
+
+  for (i = 0; i < count; i++)
+    Unpack (&into[8*i], &outof[2*i]);
+}
+#endif
+#endif
+
+#ifdef DES_CXX_CORE
+static void DESKey (UInt32 subkeys[], unsigned char key[], int encrypt, int options)
+{
+  (void)options;
+  DESKeyCxx (subkeys, key, encrypt);
+}
+#else
+#ifdef DES_KEY_TABLES
+/* Swap-moves that apply PC1 to the key as two little-endian words,
+   leaving bit j of c and d as bits j and 28 + j of the PC1 output.
+ */
+#define DES_KEY_SWAP(a, b, t, shift, mask) \
+  {                                        \
+    t = ((a >> shift) ^ b) & mask;         \
+    b ^= t;                                \
+    a ^= (t << shift);                     \
+  }
+#define DES_KEY_HALFSWAP(a, t)             \
+  {                                        \
+    t = ((a << 18) ^ a) & 0xcccc0000L;     \
+    a ^= t ^ (t >> 18);                    \
+  }
+
+/* The key schedule a word at a time.  c and d hold the two 28-bit PC1
+   halves, rotated left within 28 bits as a right shift; each KEY_PC2
+   lookup takes six of the 24 bits PC2 keeps from a half and returns their
+   place in both cooked words, so the rounds come out in DESFunction's
+   order with no CookKey pass.  The lookups are indexed by key bits, so
+   DES_OPT_CONSTTIME contexts take the masked schedule below instead.
+ */
+static void DESKeyTables (UInt32 subkeys[], unsigned char key[], int encrypt)
+{
+  UInt32 c, d, rc, rd, s, t, *cooked;
+  int i, increment, rotation;
+
+  c = (UInt32)key[0] | ((UInt32)key[1] << 8) | ((UInt32)key[2] << 16) | ((UInt32)key[3] << 24);
+  d = (UInt32)key[4] | ((UInt32)key[5] << 8) | ((UInt32)key[6] << 16) | ((UInt32)key[7] << 24);
+  DES_KEY_SWAP (d, c, t, 4, 0x0f0f0f0fL);
+  DES_KEY_HALFSWAP (c, t);
+  DES_KEY_HALFSWAP (d, t);
+  DES_KEY_SWAP (d, c, t, 1, 0x55555555L);
+  DES_KEY_SWAP (c, d, t, 8, 0x00ff00ffL);
+  DES_KEY_SWAP (d, c, t, 1, 0x55555555L);
+  d = ((d & 0x000000ffL) << 16) | (d & 0x0000ff00L) | ((d & 0x00ff0000L) >> 16) | ((c & 0xf0000000L) >> 4);
+  c &= 0x0fffffffL;
+
+  cooked = encrypt ? subkeys : &subkeys[30];
+  increment = encrypt ? 2 : -2;
+
+  for (i = 0; i < 16; i++) {
+    rotation = TOTAL_ROTATIONS[i];
+    rc = ((c >> rotation) | (c << (28 - rotation))) & 0x0fffffffL;
+    rd = ((d >> rotation) | (d << (28 - rotation))) & 0x0fffffffL;
+
+    s = KEY_PC2[0][  rc        & 0x3f]
+      | KEY_PC2[1][((rc >>  6) & 0x03) | ((rc >>  7) & 0x3c)]
+      | KEY_PC2[2][((rc >> 13) & 0x0f) | ((rc >> 14) & 0x30)]
+      | KEY_PC2[3][((rc >> 20) & 0x01) | ((rc >> 21) & 0x06) | ((rc >> 22) & 0x38)];
+    t = KEY_PC2[4][  rd        & 0x3f]
+      | KEY_PC2[5][((rd >>  7) & 0x03) | ((rd >>  8) & 0x3c)]
+      | KEY_PC2[6][ (rd >> 15) & 0x3f]
+      | KEY_PC2[7][((rd >> 21) & 0x0f) | ((rd >> 22) & 0x30)];
+
+    cooked[0] = (s & 0x3f3f0000L) | (t & 0x00003f3fL);
+    cooked[1] = ((s << 16) & 0x3f3f0000L) | ((t >> 16) & 0x00003f3fL);
+    cooked += increment;
+  }
+}
+#endif
+
+static void DESKey (UInt32 subkeys[], unsigned char key[], int encrypt, int options)
 {
   UInt32 kn[32];
   int i, j, l, m, n;
   unsigned char pc1m[56], pcr[56];
-  UInt16 BYTE_BIT[8] = {	0200, 0100, 040, 020, 010, 04, 02, 01};
-  UInt32 BIG_BYTE[24] = { 	0x800000L, 0x400000L, 0x200000L, 0x100000L,
-  							0x80000L,  0x40000L,  0x20000L,  0x10000L,
-  							0x8000L,   0x4000L,   0x2000L,   0x1000L,
-  							0x800L,    0x400L,    0x200L,    0x100L,
-  							0x80L,     0x40L,     0x20L,     0x10L,
-  							0x8L,      0x4L,      0x2L,      0x1L
-						};
-  unsigned char PC1[56] = {	56, 48, 40, 32, 24, 16,  8,      0, 57, 49, 41, 33, 25, 17,
-   							9,  1, 58, 50, 42, 34, 26,     18, 10,  2, 59, 51, 43, 35,
-  							62, 54, 46, 38, 30, 22, 14,      6, 61, 53, 45, 37, 29, 21,
-  							13,  5, 60, 52, 44, 36, 28,     20, 12,  4, 27, 19, 11,  3
-						};
-  unsigned char TOTAL_ROTATIONS[16] = { 1, 2, 4, 6, 8, 10, 12, 14, 15, 17, 19, 21, 23, 25, 27, 28};
-						
-  unsigned char PC2[48] = {	13, 16, 10, 23,  0,  4,  2, 27, 14,  5, 20,  9,
-  							22, 18, 11,  3, 25,  7, 15,  6, 26, 19, 12,  1,
- 							40, 51, 30, 36, 46, 54, 29, 39, 50, 44, 32, 47,
-  							43, 48, 38, 55, 33, 52, 45, 41, 49, 35, 28, 31
-							};
-								
-														
+
+#ifdef DES_KEY_TABLES
+  if (!(options & DES_OPT_CONSTTIME)) {
+    DESKeyTables (subkeys, key, encrypt);
+    return;
+  }
+#else
+  (void)options;
+#endif
+
   for (j = 0; j < 56; j++) {
     l = PC1[j];
     m = l & 07;
-    pc1m[j] = (unsigned char)((key[l >> 3] & BYTE_BIT[m]) ? 1 : 0);
+    pc1m[j] = (unsigned char)((key[l >> 3] >> (7 - m)) & 1);
   }
   for (i = 0; i < 16; i++) {
     m = i << 1;
@@ -1779,11 +1628,12 @@ static void DESKey (UInt32 subkeys[], unsigned char key[], int encrypt)
       else
         pcr[j] = pc1m[l - 28];
     }
+    /* Masks rather than branches, so the schedule's timing does not
+       depend on the key bits.
+     */
     for (j = 0; j < 24; j++) {
-      if (pcr[PC2[j]])
-        kn[m] |= BIG_BYTE[j];
-      if (pcr[PC2[j+24]])
-        kn[n] |= BIG_BYTE[j];
+      kn[m] |= BIG_BYTE[j] & (0L - (UInt32)pcr[PC2[j]]);
+      kn[n] |= BIG_BYTE[j] & (0L - (UInt32)pcr[PC2[j+24]]);
     }
   }
   CookKey (subkeys, kn, encrypt);
@@ -1818,302 +1668,2121 @@ static void CookKey (UInt32 *subkeys, UInt32 *kn, int encrypt)
     cooked += increment;
   }
 }
+#endif
+
+#ifdef DES_COMPACT_TABLES
+/* The round function from the packed S-boxes: the eight 4-bit outputs
+   are gathered into one word, then each bit is moved to where P and the
+   halves' rotation put it.  Slower than the SP tables, but 288 bytes of
+   constants instead of 2 KB.
+ */
+#define DES_SBOX(box, chunk) \
+  ((UInt32)(SBOX[box][((chunk) & 0x3f) >> 1] >> (((chunk) & 1) ? 0 : 4)) & 0x0fL)
+
+static UInt32 DESCompactF (UInt32 right, UInt32 k0, UInt32 k1)
+{
+  UInt32 work, sout, fval;
+  int i;
+
+  work  = (right << 28) | (right >> 4);
+  work ^= k0;
+  sout  = DES_SBOX (6, work) << 4;
+  sout |= DES_SBOX (4, work >>  8) << 12;
+  sout |= DES_SBOX (2, work >> 16) << 20;
+  sout |= DES_SBOX (0, work >> 24) << 28;
+  work  = right ^ k1;
+  sout |= DES_SBOX (7, work);
+  sout |= DES_SBOX (5, work >>  8) << 8;
+  sout |= DES_SBOX (3, work >> 16) << 16;
+  sout |= DES_SBOX (1, work >> 24) << 24;
+
+  fval = 0;
+  for (i = 0; i < 32; i++)
+    fval |= ((sout >> i) & 1L) << P_ROTATED[i];
+  return fval;
+}
+#endif
 
+/* The table rounds, one block at a time.  DES_CXX_CORE builds run the
+   unrolled rounds in DESCore.cpp instead and leave these out.
+ */
+#ifndef DES_CXX_CORE
 static void DESFunction (UInt32 *block, UInt32 *subkeys)
 {
   UInt32 fval, work, right, left;
   int round;
-  
-  UInt32 SP1[64] = {	0x01010400L, 0x00000000L, 0x00010000L, 0x01010404L,
-					  	0x01010004L, 0x00010404L, 0x00000004L, 0x00010000L,
-						0x00000400L, 0x01010400L, 0x01010404L, 0x00000400L,
-						0x01000404L, 0x01010004L, 0x01000000L, 0x00000004L,
-						0x00000404L, 0x01000400L, 0x01000400L, 0x00010400L,
-						0x00010400L, 0x01010000L, 0x01010000L, 0x01000404L,
-						0x00010004L, 0x01000004L, 0x01000004L, 0x00010004L,
-						0x00000000L, 0x00000404L, 0x00010404L, 0x01000000L,
-						0x00010000L, 0x01010404L, 0x00000004L, 0x01010000L,
-						0x01010400L, 0x01000000L, 0x01000000L, 0x00000400L,
-						0x01010004L, 0x00010000L, 0x00010400L, 0x01000004L,
-						0x00000400L, 0x00000004L, 0x01000404L, 0x00010404L,
-						0x01010404L, 0x00010004L, 0x01010000L, 0x01000404L,
-						0x01000004L, 0x00000404L, 0x00010404L, 0x01010400L,
-						0x00000404L, 0x01000400L, 0x01000400L, 0x00000000L,
-						0x00010004L, 0x00010400L, 0x00000000L, 0x01010004L
-};
-
-  UInt32 SP2[64] = {	0x80108020L, 0x80008000L, 0x00008000L, 0x00108020L,
-  						0x00100000L, 0x00000020L, 0x80100020L, 0x80008020L,
-  						0x80000020L, 0x80108020L, 0x80108000L, 0x80000000L,
-  						0x80008000L, 0x00100000L, 0x00000020L, 0x80100020L,
-  						0x00108000L, 0x00100020L, 0x80008020L, 0x00000000L,
-  						0x80000000L, 0x00008000L, 0x00108020L, 0x80100000L,
-  						0x00100020L, 0x80000020L, 0x00000000L, 0x00108000L,
-						0x00008020L, 0x80108000L, 0x80100000L, 0x00008020L,
-						0x00000000L, 0x00108020L, 0x80100020L, 0x00100000L,
-						0x80008020L, 0x80100000L, 0x80108000L, 0x00008000L,
-						0x80100000L, 0x80008000L, 0x00000020L, 0x80108020L,
-						0x00108020L, 0x00000020L, 0x00008000L, 0x80000000L,
-						0x00008020L, 0x80108000L, 0x00100000L, 0x80000020L,
-						0x00100020L, 0x80008020L, 0x80000020L, 0x00100020L,
-						0x00108000L, 0x00000000L, 0x80008000L, 0x00008020L,
-						0x80000000L, 0x80100020L, 0x80108020L, 0x00108000L
-					};
-
-  UInt32 SP3[64] = {	0x00000208L, 0x08020200L, 0x00000000L, 0x08020008L,
-						0x08000200L, 0x00000000L, 0x00020208L, 0x08000200L,
-						0x00020008L, 0x08000008L, 0x08000008L, 0x00020000L,
-						0x08020208L, 0x00020008L, 0x08020000L, 0x00000208L,
-						0x08000000L, 0x00000008L, 0x08020200L, 0x00000200L,
-						0x00020200L, 0x08020000L, 0x08020008L, 0x00020208L,
-						0x08000208L, 0x00020200L, 0x00020000L, 0x08000208L,
-						0x00000008L, 0x08020208L, 0x00000200L, 0x08000000L,
-						0x08020200L, 0x08000000L, 0x00020008L, 0x00000208L,
-						0x00020000L, 0x08020200L, 0x08000200L, 0x00000000L,
-						0x00000200L, 0x00020008L, 0x08020208L, 0x08000200L,
-						0x08000008L, 0x00000200L, 0x00000000L, 0x08020008L,
-						0x08000208L, 0x00020000L, 0x08000000L, 0x08020208L,
-						0x00000008L, 0x00020208L, 0x00020200L, 0x08000008L,
-						0x08020000L, 0x08000208L, 0x00000208L, 0x08020000L,
-						0x00020208L, 0x00000008L, 0x08020008L, 0x00020200L
-					};
-
-  UInt32 SP4[64] = {	0x00802001L, 0x00002081L, 0x00002081L, 0x00000080L,
-						0x00802080L, 0x00800081L, 0x00800001L, 0x00002001L,
-						0x00000000L, 0x00802000L, 0x00802000L, 0x00802081L,
-						0x00000081L, 0x00000000L, 0x00800080L, 0x00800001L,
-						0x00000001L, 0x00002000L, 0x00800000L, 0x00802001L,
-						0x00000080L, 0x00800000L, 0x00002001L, 0x00002080L,
-						0x00800081L, 0x00000001L, 0x00002080L, 0x00800080L,
-						0x00002000L, 0x00802080L, 0x00802081L, 0x00000081L,
-						0x00800080L, 0x00800001L, 0x00802000L, 0x00802081L,
-						0x00000081L, 0x00000000L, 0x00000000L, 0x00802000L,
-						0x00002080L, 0x00800080L, 0x00800081L, 0x00000001L,
-						0x00802001L, 0x00002081L, 0x00002081L, 0x00000080L,
-						0x00802081L, 0x00000081L, 0x00000001L, 0x00002000L,
-						0x00800001L, 0x00002001L, 0x00802080L, 0x00800081L,
-						0x00002001L, 0x00002080L, 0x00800000L, 0x00802001L,
-						0x00000080L, 0x00800000L, 0x00002000L, 0x00802080L
-					};
-
-  UInt32 SP5[64] = {	0x00000100L, 0x02080100L, 0x02080000L, 0x42000100L,
-						0x00080000L, 0x00000100L, 0x40000000L, 0x02080000L,
-						0x40080100L, 0x00080000L, 0x02000100L, 0x40080100L,
-						0x42000100L, 0x42080000L, 0x00080100L, 0x40000000L,
-						0x02000000L, 0x40080000L, 0x40080000L, 0x00000000L,
-						0x40000100L, 0x42080100L, 0x42080100L, 0x02000100L,
-						0x42080000L, 0x40000100L, 0x00000000L, 0x42000000L,
-						0x02080100L, 0x02000000L, 0x42000000L, 0x00080100L,
-						0x00080000L, 0x42000100L, 0x00000100L, 0x02000000L,
-						0x40000000L, 0x02080000L, 0x42000100L, 0x40080100L,
-						0x02000100L, 0x40000000L, 0x42080000L, 0x02080100L,
-						0x40080100L, 0x00000100L, 0x02000000L, 0x42080000L,
-						0x42080100L, 0x00080100L, 0x42000000L, 0x42080100L,
-						0x02080000L, 0x00000000L, 0x40080000L, 0x42000000L,
-						0x00080100L, 0x02000100L, 0x40000100L, 0x00080000L,
-						0x00000000L, 0x40080000L, 0x02080100L, 0x40000100L
-};
-
-  UInt32 SP6[64] = {	0x20000010L, 0x20400000L, 0x00004000L, 0x20404010L,
-						0x20400000L, 0x00000010L, 0x20404010L, 0x00400000L,
-						0x20004000L, 0x00404010L, 0x00400000L, 0x20000010L,
-						0x00400010L, 0x20004000L, 0x20000000L, 0x00004010L,
-						0x00000000L, 0x00400010L, 0x20004010L, 0x00004000L,
-						0x00404000L, 0x20004010L, 0x00000010L, 0x20400010L,
-						0x20400010L, 0x00000000L, 0x00404010L, 0x20404000L,
-						0x00004010L, 0x00404000L, 0x20404000L, 0x20000000L,
-						0x20004000L, 0x00000010L, 0x20400010L, 0x00404000L,
-						0x20404010L, 0x00400000L, 0x00004010L, 0x20000010L,
-						0x00400000L, 0x20004000L, 0x20000000L, 0x00004010L,
-						0x20000010L, 0x20404010L, 0x00404000L, 0x20400000L,
-						0x00404010L, 0x20404000L, 0x00000000L, 0x20400010L,
-						0x00000010L, 0x00004000L, 0x20400000L, 0x00404010L,
-						0x00004000L, 0x00400010L, 0x20004010L, 0x00000000L,
-						0x20404000L, 0x20000000L, 0x00400010L, 0x20004010L
-					};
-
-  UInt32 SP7[64] = {	0x00200000L, 0x04200002L, 0x04000802L, 0x00000000L,
-						0x00000800L, 0x04000802L, 0x00200802L, 0x04200800L,
-						0x04200802L, 0x00200000L, 0x00000000L, 0x04000002L,
-						0x00000002L, 0x04000000L, 0x04200002L, 0x00000802L,
-						0x04000800L, 0x00200802L, 0x00200002L, 0x04000800L,
-						0x04000002L, 0x04200000L, 0x04200800L, 0x00200002L,
-						0x04200000L, 0x00000800L, 0x00000802L, 0x04200802L,
-						0x00200800L, 0x00000002L, 0x04000000L, 0x00200800L,
-						0x04000000L, 0x00200800L, 0x00200000L, 0x04000802L,
-						0x04000802L, 0x04200002L, 0x04200002L, 0x00000002L,
-						0x00200002L, 0x04000000L, 0x04000800L, 0x00200000L,
-						0x04200800L, 0x00000802L, 0x00200802L, 0x04200800L,
-						0x00000802L, 0x04000002L, 0x04200802L, 0x04200000L,
-						0x00200800L, 0x00000000L, 0x00000002L, 0x04200802L,
-						0x00000000L, 0x00200802L, 0x04200000L, 0x00000800L,
-						0x04000002L, 0x04000800L, 0x00000800L, 0x00200002L
-					};
-
-  UInt32 SP8[64] = {	0x10001040L, 0x00001000L, 0x00040000L, 0x10041040L,
-						0x10000000L, 0x10001040L, 0x00000040L, 0x10000000L,
-						0x00040040L, 0x10040000L, 0x10041040L, 0x00041000L,
-						0x10041000L, 0x00041040L, 0x00001000L, 0x00000040L,
-						0x10040000L, 0x10000040L, 0x10001000L, 0x00001040L,
-						0x00041000L, 0x00040040L, 0x10040040L, 0x10041000L,
-						0x00001040L, 0x00000000L, 0x00000000L, 0x10040040L,
-						0x10000040L, 0x10001000L, 0x00041040L, 0x00040000L,
-						0x00041040L, 0x00040000L, 0x10041000L, 0x00001000L,
-						0x00000040L, 0x10040040L, 0x00001000L, 0x00041040L,
-						0x10001000L, 0x00000040L, 0x10000040L, 0x10040000L,
-						0x10040040L, 0x10000000L, 0x00040000L, 0x10001040L,
-						0x00000000L, 0x10041040L, 0x00040040L, 0x10000040L,
-						0x10040000L, 0x10001000L, 0x10001040L, 0x00000000L,
-						0x10041040L, 0x00041000L, 0x00041000L, 0x00001040L,
-						0x00001040L, 0x00040040L, 0x10000000L, 0x10041000L
-					};
-  
+
   left = block[0];
   right = block[1];
-  work = ((left >> 4) ^ right) & 0x0f0f0f0fL;
-  right ^= work;
-  left ^= (work << 4);
-  work = ((left >> 16) ^ right) & 0x0000ffffL;
-  right ^= work;
-  left ^= (work << 16);
-  work = ((right >> 2) ^ left) & 0x33333333L;
-  left ^= work;
-  right ^= (work << 2);
-  work = ((right >> 8) ^ left) & 0x00ff00ffL;
-  left ^= work;
-  right ^= (work << 8);
-  right = ((right << 1) | ((right >> 31) & 1L)) & 0xffffffffL;
-  work = (left ^ right) & 0xaaaaaaaaL;
-  left ^= work;
-  right ^= work;
-  left = ((left << 1) | ((left >> 31) & 1L)) & 0xffffffffL;
+  DES_IP (left, right, work);
   
   for (round = 0; round < 8; round++) {
-    work  = (right << 28) | (right >> 4);
-    work ^= *subkeys++;
-    fval  = SP7[ work        & 0x3fL];
-    fval |= SP5[(work >>  8) & 0x3fL];
-    fval |= SP3[(work >> 16) & 0x3fL];
-    fval |= SP1[(work >> 24) & 0x3fL];
-    work  = right ^ *subkeys++;
-    fval |= SP8[ work        & 0x3fL];
-    fval |= SP6[(work >>  8) & 0x3fL];
-    fval |= SP4[(work >> 16) & 0x3fL];
-    fval |= SP2[(work >> 24) & 0x3fL];
-    left ^= fval;
-    work  = (left << 28) | (left >> 4);
-    work ^= *subkeys++;
-    fval  = SP7[ work        & 0x3fL];
-    fval |= SP5[(work >>  8) & 0x3fL];
-    fval |= SP3[(work >> 16) & 0x3fL];
-    fval |= SP1[(work >> 24) & 0x3fL];
-    work  = left ^ *subkeys++;
-    fval |= SP8[ work        & 0x3fL];
-    fval |= SP6[(work >>  8) & 0x3fL];
-    fval |= SP4[(work >> 16) & 0x3fL];
-    fval |= SP2[(work >> 24) & 0x3fL];
-    right ^= fval;
+    DES_ROUND (left, right, subkeys, fval, work);
+    DES_ROUND (right, left, subkeys, fval, work);
   }
   
-  right = (right << 31) | (right >> 1);
-  work = (left ^ right) & 0xaaaaaaaaL;
-  left ^= work;
-  right ^= work;
-  left = (left << 31) | (left >> 1);
-  work = ((left >> 8) ^ right) & 0x00ff00ffL;
-  right ^= work;
-  left ^= (work << 8);
-  work = ((left >> 2) ^ right) & 0x33333333L;
-  right ^= work;
-  left ^= (work << 2);
-  work = ((right >> 16) ^ left) & 0x0000ffffL;
-  left ^= work;
-  right ^= (work << 16);
-  work = ((right >> 4) ^ left) & 0x0f0f0f0fL;
-  left ^= work;
-  right ^= (work << 4);
+  DES_FP (left, right, work);
   *block++ = right;
   *block = left;
 }
 
+#ifndef DES_NO_DES3
+/* Triple-DES on one block: the three DESFunction passes with the inner
+   FP/IP pairs removed.  FP followed by IP only swaps the halves, so the
+   block stays in the round domain from the first IP to the last FP.
+ */
+static void DES3Function (UInt32 *block, UInt32 (*subkeys)[32])
+{
+  UInt32 fval, work, right, left, *keys;
+  int pass, round;
+
+  left = block[0];
+  right = block[1];
+  DES_IP (left, right, work);
+
+  for (pass = 0; pass < 3; pass++) {
+    keys = subkeys[pass];
+    for (round = 0; round < 8; round++) {
+      DES_ROUND (left, right, keys, fval, work);
+      DES_ROUND (right, left, keys, fval, work);
+    }
+    if (pass < 2) {
+      work = left;
+      left = right;
+      right = work;
+    }
+  }
+
+  DES_FP (left, right, work);
+  *block++ = right;
+  *block = left;
+}
+#endif
+#endif
+
+#if !defined(DES_NO_OFB) || !defined(DES_NO_DESX)
+/* DESFunction between its IP and FP, for DES_ROUNDS.  FP followed by the
+   next IP would only swap the halves, so the result is stored swapped.
+ */
+static void DESRounds (UInt32 *halves, UInt32 *subkeys)
+{
+  UInt32 fval, work, right, left;
+  int round;
+
+  left = halves[0];
+  right = halves[1];
+
+  for (round = 0; round < 8; round++) {
+    DES_ROUND (left, right, subkeys, fval, work);
+    DES_ROUND (right, left, subkeys, fval, work);
+  }
+
+  halves[0] = right;
+  halves[1] = left;
+}
+#endif
+
+#ifndef DES_NO_DESX
+/* DESX on one block with the context's direction-resolved whiteners,
+   which DESX_Init keeps in the IP domain.  The whitening is two xors on
+   the round halves on either side of the rounds, so DESX costs what
+   DES does.
+ */
+static void DESXFunction (DES_CTX *context, UInt32 *block)
+{
+  UInt32 halves[2], work;
+
+  DES_TO_IP (halves, block, work);
+  halves[0] ^= context->preWhitener[0];
+  halves[1] ^= context->preWhitener[1];
+  DES_ROUNDS (context, halves, context->subkeys[0]);
+  halves[0] ^= context->postWhitener[0];
+  halves[1] ^= context->postWhitener[1];
+  DES_FROM_IP (block, halves, work);
+}
+#endif
+
+#if !defined(DES_NO_CFB) || !defined(DES_NO_OFB) || !defined(DES_NO_CTR) || (defined(DES_THREADS) && !defined(DES_NO_CBC))
+/* The cipher for one feedback or counter step, or one block of a
+   threaded CBC decryption: the block in, the output back in its place.
+   DESFeedbackRounds does the same on a register kept in the IP domain.
+ */
+static void DESFeedbackFunction (DES_CTX *context, UInt32 *block, int destype)
+{
+  switch (destype) {
+#ifndef DES_NO_DESX
+    case DESX:
+      DESXFunction (context, block);
+      break;
+#endif
+#ifndef DES_NO_DES3
+    case DES3:
+      DES3_FUNCTION (context, block, context->subkeys);
+      break;
+#endif
+    default:
+      DES_FUNCTION (context, block, context->subkeys[0]);
+  }
+}
+#endif
+
+#if !defined(DES_NO_CFB) || !defined(DES_NO_OFB)
+/* The CFB and OFB engine behind every *_CFBUpdate and *_OFB*Update.  The
+   feedback register is one 64-bit word, held as a pair of UInt32 since
+   the 68K has nothing wider, and the message is a string of n-bit
+   segments for any n from 1 to 64.  Each segment costs one cipher call,
+   a mask of the output to its top n bits and a shift of n bits into the
+   register, so no segment size has a path of its own.  The output starts
+   as a copy of the input and each keystream segment is xored into it in
+   place, which leaves the neighbouring bits of a shared byte alone.
+
+   Calls may end inside a segment.  The segment's keystream stays in
+   context->keystream with context->keystreamUsed bits of it spent, and
+   the next call picks it up there, so any split of a message gives what
+   one call over all of it would.  OFB moves the register on when it
+   makes the keystream; CFB shifts the cipher text in as it goes.
+
+   Earlier releases had layouts of their own for DES and DESX CFB with
+   16-bit segments, OFB with 1-bit segments and DESX ISO OFB, none of
+   them FIPS 81 or ISO 10116, and the 1-bit OFB one leaves two bits of
+   every block in the clear.  Contexts with DES_OPT_LEGACY_FEEDBACK get
+   them back, each described where it is done, to read data written
+   that way; context->blockBits counts the bits into the current 64-bit
+   block for them.  Everything else takes the plain engine.  DES3 and
+   CFB with 1-bit segments never deciphered their own output, so they
+   have no legacy layout to keep.
+ */
+#define DES_FEEDBACK_PLAIN 0     /* register and keystream as the cipher has them */
+#define DES_FEEDBACK_IP 1        /* register kept in the IP domain */
+#define DES_FEEDBACK_WHITENED 2  /* DESX ISO OFB, whitened around single DES */
+
+static int DESFeedback (DES_CTX *context, unsigned char *output, unsigned char *input, unsigned long len, int destype, int desmode)
+{
+  /* A bad segment size is refused before the output is touched, so a
+     caller that misses the error is not left holding its plain text.
+   */
+  if ((context->n < 1) || (context->n > 64))
+    return RE_LEN;
+
+  if (output != input)
+    MemMove (output, input, len);
+
+#ifndef DES_NO_OFB
+  /* OFB keystream made ahead by FillLookahead_DES comes first.  The
+     register already stands at its end, so the rest of the call carries
+     on from there.
+   */
+  if ((desmode != CFB) && context->aheadCount) {
+    unsigned long ahead;
+
+    ahead = DESUseLookahead (context, output, len);
+    output += ahead;
+    len -= ahead;
+  }
+#endif
+  return DESFeedbackRun (context, output, len, destype, desmode);
+}
+
+/* The engine itself, on data that is input and output at once.  Its
+   callers have checked the segment size.
+ */
+static int DESFeedbackRun (DES_CTX *context, unsigned char *data, unsigned long len, int destype, int desmode)
+{
+  UInt32 reg[2], keystream[2], window[2], segment[2];
+  int n, layout, legacy, used, take, shift, phase;
+#ifndef DES_NO_OFB
+  int k;
+#endif
+
+  n = context->n;
+
+  /* ISO 10116 OFB, and FIPS 81 OFB with 64-bit feedback, feed the whole
+     cipher output back, so the register stays in the IP domain between
+     segments and only the copy that reaches the data goes through FP.
+   */
+  legacy = (destype != DES3) && (context->options & DES_OPT_LEGACY_FEEDBACK);
+
+  /* Legacy DESX ISO OFB runs single DES on the register whitened with
+     the left half of the input whitener, feeds back the output whitened
+     with the output whitener, and xors that whitener into the data at
+     its place in each 64-bit block.
+   */
+  if (legacy && (destype == DESX) && (desmode == OFBISO))
+    layout = DES_FEEDBACK_WHITENED;
+  else if ((desmode == OFBISO) || ((desmode == OFBFIPS81) && (n == 64)))
+    layout = DES_FEEDBACK_IP;
+  else
+    layout = DES_FEEDBACK_PLAIN;
+  reg[0] = context->iv[0];
+  reg[1] = context->iv[1];
+#ifndef DES_NO_OFB
+  if (layout == DES_FEEDBACK_IP) {
+    DES_TO_IP (reg, context->iv, segment[0]);
+  }
+#endif
+  keystream[0] = context->keystream[0];
+  keystream[1] = context->keystream[1];
+  used = context->keystreamUsed;
+  phase = context->blockBits;
+
+  /* The data is walked as a byte pointer and a bit offset into that
+     byte, never as a bit count, which would wrap at 512 MB where
+     unsigned long is 32 bits.
+   */
+  shift = 0;
+  while (len) {
+#ifndef DES_NO_OFB
+    /* Legacy DES and DESX OFB with 1-bit segments puts the keystream
+       of the 57th to 62nd segments of a 64-bit block two bits on, leaves
+       the block's 57th and 58th bits as they were and drops the last
+       two segments' keystream.  The last byte of each block is done here
+       in one step.
+     */
+    if (legacy && (desmode != CFB) && (n == 1) && (phase == 56)) {
+      window[0] = window[1] = 0;
+      for (k = 0; k < 8; k++) {
+        DESFeedbackNext (context, reg, keystream, n, destype, desmode, layout);
+        if (k < 6)
+          window[0] |= (keystream[0] & 0x80000000) >> (k + 2);
+      }
+      take = 8;
+    }
+    else
+#endif
+    {
+      if (used == 0)
+        DESFeedbackNext (context, reg, keystream, n, destype, desmode, layout);
+
+      /* The part of the segment this call reaches, moved to the top.
+       */
+      take = n - used;
+      window[0] = keystream[0];
+      window[1] = keystream[1];
+      if (used) {
+        segment[0] = segment[1] = 0;
+        DESShiftIn (window, segment, used);
+      }
+      if ((len < 9) && ((unsigned long)take > 8 * len - shift)) {
+        take = (int)(8 * len) - shift;
+        DESMaskSegment (window, take);
+      }
+    }
+
+#if !defined(DES_NO_DESX) && !defined(DES_NO_OFB)
+    if (layout == DES_FEEDBACK_WHITENED) {
+      DESRotateLeft (segment, context->outputWhitener, phase);
+      DESMaskSegment (segment, take);
+      window[0] ^= segment[0];
+      window[1] ^= segment[1];
+    }
+#endif
+
+    if (desmode == CFB) {
+      DESLoadSegment (segment, data, shift, take);
+      DESXorSegment (data, shift, window, take);
+      if (context->encrypt == ENCRYPT) {
+        segment[0] ^= window[0];
+        segment[1] ^= window[1];
+      }
+      DESShiftIn (reg, segment, take);
+    }
+    else
+      DESXorSegment (data, shift, window, take);
+
+    used += take;
+    if (used >= n) {
+      used = 0;
+
+      /* Legacy DES and DESX CFB with 16-bit segments puts the
+         segment's keystream, not the register's old low half, above the
+         cipher text just shifted in.
+       */
+      if (legacy && (desmode == CFB) && (n == 16))
+        reg[1] = (reg[1] & 0x0000FFFF) | keystream[0];
+    }
+    phase = (phase + take) & 63;
+    shift += take;
+    data += shift >> 3;
+    len -= shift >> 3;
+    shift &= 7;
+  }
+
+  context->iv[0] = reg[0];
+  context->iv[1] = reg[1];
+#ifndef DES_NO_OFB
+  if (layout == DES_FEEDBACK_IP) {
+    DES_FROM_IP (context->iv, reg, segment[0]);
+  }
+#endif
+  context->keystream[0] = keystream[0];
+  context->keystream[1] = keystream[1];
+  context->keystreamUsed = used;
+  context->blockBits = phase;
+  return (0);
+}
+
+/* The next keystream segment, masked to its n bits, with an OFB register
+   moved on past it.  CFB moves its register as the cipher text comes.
+ */
+static void DESFeedbackNext (DES_CTX *context, UInt32 *reg, UInt32 *keystream, int n, int destype, int desmode, int layout)
+{
+#ifndef DES_NO_OFB
+  UInt32 work;
+
+#endif
+  switch (layout) {
+#ifndef DES_NO_OFB
+    case DES_FEEDBACK_IP:
+      DESFeedbackRounds (context, reg, destype);
+      DES_FROM_IP (keystream, reg, work);
+      break;
+#ifndef DES_NO_DESX
+    case DES_FEEDBACK_WHITENED:
+      keystream[0] = reg[0] ^ context->inputWhitener[0];
+      keystream[1] = reg[1] ^ context->inputWhitener[0];
+      DES_FUNCTION (context, keystream, context->subkeys[0]);
+      reg[0] = keystream[0] ^ context->outputWhitener[0];
+      reg[1] = keystream[1] ^ context->outputWhitener[1];
+      break;
+#endif
+#endif
+    default:
+      keystream[0] = reg[0];
+      keystream[1] = reg[1];
+      DESFeedbackFunction (context, keystream, destype);
+  }
+  DESMaskSegment (keystream, n);
+  if ((layout == DES_FEEDBACK_PLAIN) && (desmode != CFB))
+    DESShiftIn (reg, keystream, n);
+}
+
+#if !defined(DES_NO_DESX) && !defined(DES_NO_OFB)
+/* The 64-bit block rotated left by n bits, 0 <= n < 64.
+ */
+static void DESRotateLeft (UInt32 *out, UInt32 *in, int n)
+{
+  UInt32 hi, lo;
+
+  hi = in[(n >> 5) & 1];
+  lo = in[((n >> 5) + 1) & 1];
+  n &= 31;
+  if (n) {
+    out[0] = (hi << n) | (lo >> (32 - n));
+    out[1] = (lo << n) | (hi >> (32 - n));
+  }
+  else {
+    out[0] = hi;
+    out[1] = lo;
+  }
+}
+#endif
+
+#ifndef DES_NO_OFB
+static void DESFeedbackRounds (DES_CTX *context, UInt32 *halves, int destype)
+{
+  switch (destype) {
+#ifndef DES_NO_DESX
+    case DESX:
+      halves[0] ^= context->preWhitener[0];
+      halves[1] ^= context->preWhitener[1];
+      DES_ROUNDS (context, halves, context->subkeys[0]);
+      halves[0] ^= context->postWhitener[0];
+      halves[1] ^= context->postWhitener[1];
+      break;
+#endif
+#ifndef DES_NO_DES3
+    case DES3:
+      DES3_ROUNDS (context, halves, context->subkeys);
+      break;
+#endif
+    default:
+      DES_ROUNDS (context, halves, context->subkeys[0]);
+  }
+}
+#endif
+
+/* Shifts the register n bits left and the top n bits of in into the
+   vacated end.
+ */
+static void DESShiftIn (UInt32 *reg, UInt32 *in, int n)
+{
+  if (n == 64) {
+    reg[0] = in[0];
+    reg[1] = in[1];
+  }
+  else if (n == 32) {
+    reg[0] = reg[1];
+    reg[1] = in[0];
+  }
+  else if (n > 32) {
+    reg[0] = (reg[1] << (n - 32)) | (in[0] >> (64 - n));
+    reg[1] = (in[0] << (n - 32)) | (in[1] >> (64 - n));
+  }
+  else {
+    reg[0] = (reg[0] << n) | (reg[1] >> (32 - n));
+    reg[1] = (reg[1] << n) | (in[0] >> (32 - n));
+  }
+}
+
+/* Clears the bits of a left-justified segment past its first n.
+ */
+static void DESMaskSegment (UInt32 *segment, int n)
+{
+  if (n < 32) {
+    segment[0] &= ~(0xFFFFFFFF >> n);
+    segment[1] = 0;
+  }
+  else if (n < 64)
+    segment[1] &= ~(0xFFFFFFFF >> (n - 32));
+}
+
+/* The n bits of a message at bit offset bit, left-justified in segment
+   and zero past them.  Only the bytes that hold them are read.
+ */
+static void DESLoadSegment (UInt32 *segment, unsigned char *from, unsigned long bit, int n)
+{
+  UInt32 spill;
+  int k, count, shift;
+
+  from += bit >> 3;
+  shift = (int)(bit & 7);
+  count = (shift + n + 7) >> 3;
+
+  segment[0] = segment[1] = spill = 0;
+  for (k = 0; k < count; k++) {
+    if (k < 4)
+      segment[0] |= (UInt32)from[k] << (24 - 8 * k);
+    else if (k < 8)
+      segment[1] |= (UInt32)from[k] << (56 - 8 * k);
+    else
+      spill = from[k];
+  }
+
+  if (shift) {
+    segment[0] = (segment[0] << shift) | (segment[1] >> (32 - shift));
+    segment[1] = (segment[1] << shift) | (spill >> (8 - shift));
+  }
+  DESMaskSegment (segment, n);
+}
+
+/* Xors a left-justified segment, zero past its n bits, into a message
+   at bit offset bit.
+ */
+static void DESXorSegment (unsigned char *into, unsigned long bit, UInt32 *segment, int n)
+{
+  UInt32 high, low, spill;
+  int k, count, shift;
+
+  into += bit >> 3;
+  shift = (int)(bit & 7);
+  count = (shift + n + 7) >> 3;
+
+  high = segment[0];
+  low = segment[1];
+  spill = 0;
+  if (shift) {
+    spill = low << (8 - shift);
+    low = (low >> shift) | (high << (32 - shift));
+    high >>= shift;
+  }
+
+  for (k = 0; k < count; k++) {
+    if (k < 4)
+      into[k] ^= (unsigned char)(high >> (24 - 8 * k));
+    else if (k < 8)
+      into[k] ^= (unsigned char)(low >> (56 - 8 * k));
+    else
+      into[k] ^= (unsigned char)spill;
+  }
+}
+
+#ifndef DES_NO_OFB
+/* Xors as much of the lookahead ring into data as there is, up to len
+   bytes, and returns how much that was.
+ */
+static unsigned long DESUseLookahead (DES_CTX *context, unsigned char *data, unsigned long len)
+{
+  unsigned long used, piece;
+
+  used = (len < context->aheadCount) ? len : context->aheadCount;
+  piece = context->aheadSize - context->aheadStart;
+  if (piece > used)
+    piece = used;
+
+  DESXorBytes (data, data, context->ahead + context->aheadStart, piece);
+  DESXorBytes (data + piece, data + piece, context->ahead, used - piece);
+
+  context->aheadStart = (context->aheadStart + used) % context->aheadSize;
+  context->aheadCount -= used;
+  return used;
+}
+#endif
+#endif
+
+#if !defined(DES_NO_OFB) || !defined(DES_NO_CTR)
+/* into = from ^ with over len bytes, a word at a time where the words
+   line up.  into may be from.
+ */
+static void DESXorBytes (unsigned char *into, unsigned char *from, unsigned char *with, unsigned long len)
+{
+#ifdef DES_PACK64
+  unsigned long long a, b;
+
+  for (; len >= 8; len -= 8, into += 8, from += 8, with += 8) {
+    __builtin_memcpy (&a, from, 8);
+    __builtin_memcpy (&b, with, 8);
+    a ^= b;
+    __builtin_memcpy (into, &a, 8);
+  }
+#else
+  if (!(((unsigned long)into | (unsigned long)from | (unsigned long)with) & 3))
+    for (; len >= 4; len -= 4, into += 4, from += 4, with += 4)
+      *(UInt32 *)into = *(UInt32 *)from ^ *(UInt32 *)with;
+#endif
+  for (; len; len--)
+    *into++ = *from++ ^ *with++;
+}
+#endif
+
+#ifndef DES_NO_CTR
+/* The CTR engine behind every *_CTRUpdate.  context->iv holds the next
+   counter block and context->originalIV the first, so block i of a
+   message is enciphered from the IV plus i.  Only the low
+   context->counterBits bits count, wrapping within themselves; the bits
+   above them are the nonce and never change.  A call that ends inside a
+   block keeps the block's keystream in context->keystream with
+   context->keystreamUsed bits of it spent, as CFB and OFB do, and the
+   next call starts there.  No block needs another to be made first, so
+   the whole blocks in between go to DESCounterRun in one piece.
+ */
+static int DESCounter (DES_CTX *context, unsigned char *output, unsigned char *input, unsigned long len, int destype)
+{
+  unsigned char keystream[8];
+  unsigned long blocks, take;
+  int used;
+
+  used = context->keystreamUsed / 8;
+  if (used && len) {
+    Unpack (keystream, context->keystream);
+    take = 8 - used;
+    if (take > len)
+      take = len;
+    DESXorBytes (output, input, keystream + used, take);
+    output += take;
+    input += take;
+    len -= take;
+    context->keystreamUsed = 8 * (int)((used + take) & 7);
+  }
+
+  blocks = len / 8;
+  if (blocks) {
+    DESCounterRun (context, output, input, blocks, destype);
+    DESCounterAdd (context->iv, context->counterBits, blocks);
+    output += 8 * blocks;
+    input += 8 * blocks;
+    len -= 8 * blocks;
+  }
+
+  if (len) {
+    DESCounterKeystream (context, destype);
+    Unpack (keystream, context->keystream);
+    DESXorBytes (output, input, keystream, len);
+    context->keystreamUsed = 8 * (int)len;
+  }
+  return (0);
+}
+
+/* Whole blocks from the counter in context->iv on; the caller moves the
+   counter past them.  DES_THREADS builds cut a large run into one piece
+   per thread, each from its own first counter.
+ */
+static void DESCounterRun (DES_CTX *context, unsigned char *output, unsigned char *input, unsigned long blocks, int destype)
+{
+#ifdef DES_THREADS
+  DESThreadJob jobs[DES_THREAD_MAX];
+  unsigned long first, share;
+  int threads, t;
+
+  threads = DESThreadCount (context, blocks);
+  if (threads > 1) {
+    share = blocks / threads;
+    share -= share % DES_CTR_BATCH;
+    for (t = 0, first = 0; t < threads; t++, first += share) {
+      jobs[t].context = context;
+      jobs[t].output = &output[8*first];
+      jobs[t].input = &input[8*first];
+      jobs[t].blocks = (t == threads - 1) ? blocks - first : share;
+      jobs[t].iv[0] = context->iv[0];
+      jobs[t].iv[1] = context->iv[1];
+      DESCounterAdd (jobs[t].iv, context->counterBits, first);
+      jobs[t].destype = destype;
+    }
+    DESRunThreads (jobs, threads, DESCounterJob);
+    return;
+  }
+#endif
+  DESCounterBlocks (context, output, input, blocks, context->iv, destype);
+}
+
+/* Enciphers the blocks counter values from counter on and xors them into
+   the data, DES_CTR_BATCH of them through the multi-block kernels at a
+   time.  counter itself is left alone, so the pieces of a threaded run
+   share the context without writing to it.
+ */
+static void DESCounterBlocks (DES_CTX *context, unsigned char *output, unsigned char *input, unsigned long blocks, UInt32 *counter, int destype)
+{
+  unsigned char stream[8*DES_CTR_BATCH];
+  UInt32 next[2], block[2];
+  unsigned long done, i;
+  int count, j;
+
+  next[0] = counter[0];
+  next[1] = counter[1];
+  for (done = 0; done < blocks; done += count) {
+    count = (blocks - done < DES_CTR_BATCH) ? (int)(blocks - done) : DES_CTR_BATCH;
+    for (j = 0; j < count; j++) {
+      Unpack (&stream[8*j], next);
+      DESCounterAdd (next, context->counterBits, 1);
+    }
+
+    i = DESMultiBlock (context, stream, stream, count,
+                       (destype == DESX) ? context->inputWhitener : NULL,
+                       (destype == DESX) ? context->outputWhitener : NULL,
+                       (destype == DES3) ? 3 : 1, NULL);
+    for (; i < (unsigned long)count; i++) {
+      Pack (block, &stream[8*i]);
+      DESFeedbackFunction (context, block, destype);
+      Unpack (&stream[8*i], block);
+    }
+
+    DESXorBytes (&output[8*done], &input[8*done], stream, 8 * (unsigned long)count);
+  }
+}
+
+/* Adds count to the counter in the low bits bits of block, modulo 2 to
+   the bits; the nonce above them is kept.  The 68K's unsigned long has
+   no high word to carry, so the shift is split in two.
+ */
+static void DESCounterAdd (UInt32 *block, int bits, unsigned long count)
+{
+  UInt32 low, high, mask[2];
+
+  low = block[1] + (UInt32)count;
+  high = block[0] + (UInt32)((count >> 16) >> 16) + (low < block[1]);
+  mask[0] = (bits >= 64) ? 0xFFFFFFFF : (bits > 32) ? (0xFFFFFFFF >> (64 - bits)) : 0;
+  mask[1] = (bits >= 32) ? 0xFFFFFFFF : (0xFFFFFFFF >> (32 - bits));
+  block[0] = (block[0] & ~mask[0]) | (high & mask[0]);
+  block[1] = (block[1] & ~mask[1]) | (low & mask[1]);
+}
+
+/* The keystream block for the counter in context->iv, into
+   context->keystream, with the counter moved on past it.
+ */
+static void DESCounterKeystream (DES_CTX *context, int destype)
+{
+  context->keystream[0] = context->iv[0];
+  context->keystream[1] = context->iv[1];
+  DESFeedbackFunction (context, context->keystream, destype);
+  DESCounterAdd (context->iv, context->counterBits, 1);
+}
+
+#ifdef DES_THREADS
+static void *DESCounterJob (void *job)
+{
+  DESThreadJob *piece = (DESThreadJob *)job;
+
+  DESCounterBlocks (piece->context, piece->output, piece->input, piece->blocks, piece->iv, piece->destype);
+  return NULL;
+}
+#endif
+#endif
+
+#ifndef DES_NO_CBC
+/* Front end for the CBC-decrypt loops.  Returns how many of the blocks
+   it decrypted, with context->iv left at the last of their ciphertext
+   blocks, and the caller does the rest one at a time.  A plaintext block
+   needs only its own ciphertext block and the one before, so
+   DES_THREADS builds cut a large run into one piece per thread, each
+   with the ciphertext block before it as its IV.  Those IVs and the
+   last block, the next call's IV, are read before any thread starts:
+   in place, a piece overwrites the block the next piece chains from.
+ */
+static unsigned long DESChainRun (DES_CTX *context, unsigned char *output, unsigned char *input, unsigned long blocks, int destype)
+{
+#ifdef DES_THREADS
+  DESThreadJob jobs[DES_THREAD_MAX];
+  UInt32 last[2];
+  unsigned long first, share;
+  int threads, t;
+
+  threads = DESThreadCount (context, blocks);
+  if (threads > 1) {
+    share = blocks / threads;
+    for (t = 0, first = 0; t < threads; t++, first += share) {
+      jobs[t].context = context;
+      jobs[t].output = &output[8*first];
+      jobs[t].input = &input[8*first];
+      jobs[t].blocks = (t == threads - 1) ? blocks - first : share;
+      if (t)
+        Pack (jobs[t].iv, &input[8*(first-1)]);
+      else {
+        jobs[t].iv[0] = context->iv[0];
+        jobs[t].iv[1] = context->iv[1];
+      }
+      jobs[t].destype = destype;
+    }
+    Pack (last, &input[8*(blocks-1)]);
+    DESRunThreads (jobs, threads, DESChainJob);
+    context->iv[0] = last[0];
+    context->iv[1] = last[1];
+    return blocks;
+  }
+#endif
+  return DESMultiBlock (context, output, input, blocks,
+                        (destype == DESX) ? context->outputWhitener : NULL,
+                        (destype == DESX) ? context->inputWhitener : NULL,
+                        (destype == DES3) ? 3 : 1, context->iv);
+}
+
+#ifdef DES_THREADS
+/* One piece of a threaded CBC decryption, chained from iv, which moves
+   along the piece as context->iv does in the serial loop.
+ */
+static void DESChainBlocks (DES_CTX *context, unsigned char *output, unsigned char *input, unsigned long blocks, UInt32 *iv, int destype)
+{
+  UInt32 inputBlock[2], work[2];
+  unsigned long i;
+
+  i = DESMultiBlock (context, output, input, blocks,
+                     (destype == DESX) ? context->outputWhitener : NULL,
+                     (destype == DESX) ? context->inputWhitener : NULL,
+                     (destype == DES3) ? 3 : 1, iv);
+  for (; i < blocks; i++) {
+    Pack (inputBlock, &input[8*i]);
+    work[0] = inputBlock[0];
+    work[1] = inputBlock[1];
+    DESFeedbackFunction (context, work, destype);
+    work[0] ^= iv[0];
+    work[1] ^= iv[1];
+    iv[0] = inputBlock[0];
+    iv[1] = inputBlock[1];
+    Unpack (&output[8*i], work);
+  }
+}
+
+static void *DESChainJob (void *job)
+{
+  DESThreadJob *piece = (DESThreadJob *)job;
+
+  DESChainBlocks (piece->context, piece->output, piece->input, piece->blocks, piece->iv, piece->destype);
+  return NULL;
+}
+#endif
+#endif
+
+#if defined(DES_THREADS) && (!defined(DES_NO_CTR) || !defined(DES_NO_CBC))
+/* How many threads a run of blocks is worth: context->threads, or one
+   per online processor when that is 0, but never so many that a thread
+   gets less than DES_THREAD_MIN bytes.
+ */
+static int DESThreadCount (DES_CTX *context, unsigned long blocks)
+{
+  long threads;
+
+  threads = context->threads;
+  if (threads <= 0)
+    threads = sysconf (_SC_NPROCESSORS_ONLN);
+  if (threads > DES_THREAD_MAX)
+    threads = DES_THREAD_MAX;
+  if (threads < 1)
+    return 1;
+  if ((unsigned long)threads > blocks / (DES_THREAD_MIN / 8))
+    threads = (long)(blocks / (DES_THREAD_MIN / 8));
+  return (threads < 1) ? 1 : (int)threads;
+}
+
+/* Runs work on each of count jobs, the first on the calling thread and
+   the rest on threads of their own, and returns when all are done.  A
+   job whose thread cannot be started runs on the calling thread as well.
+ */
+static void DESRunThreads (DESThreadJob *jobs, int count, void *(*work)(void *))
+{
+  int started[DES_THREAD_MAX], t;
+
+  for (t = 1; t < count; t++)
+    started[t] = (pthread_create (&jobs[t].thread, NULL, work, &jobs[t]) == 0);
+  work (&jobs[0]);
+  for (t = 1; t < count; t++) {
+    if (started[t])
+      pthread_join (jobs[t].thread, NULL);
+    else
+      work (&jobs[t]);
+  }
+}
+#endif
+
+#ifdef DES_BIG_SP
+/* Merged SP tables: each entry is the OR of two neighbouring SPn entries,
+   indexed by both 6-bit chunks at once, so a round does four lookups
+   instead of eight.  At 64 KB they cannot live in a code resource, so
+   they are built from SP1..SP8 by DESBigSPInit on the first
+   Initialize_DES.  DES_THREADS builds, whose callers may initialize
+   contexts on several threads at once, build them under pthread_once
+   so that no thread sees the flag before the tables.
+ */
+static UInt32 BigSP[4][4096] DES_TABLE_ALIGN;
+#ifdef DES_THREADS
+static pthread_once_t BigSPOnce = PTHREAD_ONCE_INIT;
+#else
+static int BigSPReady;
+#endif
+
+static void DESBigSPReady (void)
+{
+#ifdef DES_THREADS
+  pthread_once (&BigSPOnce, DESBigSPInit);
+#else
+  if (!BigSPReady)
+    DESBigSPInit ();
+#endif
+}
+
+static void DESBigSPInit (void)
+{
+  int i;
+
+  for (i = 0; i < 4096; i++) {
+    BigSP[0][i] = SP7[i & 0x3f] | SP5[i >> 6];
+    BigSP[1][i] = SP3[i & 0x3f] | SP1[i >> 6];
+    BigSP[2][i] = SP8[i & 0x3f] | SP6[i >> 6];
+    BigSP[3][i] = SP4[i & 0x3f] | SP2[i >> 6];
+  }
+#ifndef DES_THREADS
+  BigSPReady = 1;
+#endif
+}
+
+/* Same as DESFunction, but each pair of 6-bit chunks in a work word
+   (bits 0-5 with 8-13, and 16-21 with 24-29) is squeezed into one 12-bit
+   index into the merged tables.
+ */
+#define DES_ROUND_BIG(left, right, subkeys, fval, work)                      \
+  {                                                                        \
+    work  = (right << 28) | (right >> 4);                                  \
+    work ^= *subkeys++;                                                    \
+    fval  = BigSP[0][( work        & 0x3fL) | ((work >>  2) & 0xfc0L)];    \
+    fval |= BigSP[1][((work >> 16) & 0x3fL) | ((work >> 18) & 0xfc0L)];    \
+    work  = right ^ *subkeys++;                                            \
+    fval |= BigSP[2][( work        & 0x3fL) | ((work >>  2) & 0xfc0L)];    \
+    fval |= BigSP[3][((work >> 16) & 0x3fL) | ((work >> 18) & 0xfc0L)];    \
+    left ^= fval;                                                          \
+  }
+
+#ifndef DES_CXX_CORE
+static void DESFunctionBig (UInt32 *block, UInt32 *subkeys)
+{
+  UInt32 fval, work, right, left;
+  int round;
+
+  left = block[0];
+  right = block[1];
+  DES_IP (left, right, work);
+
+  for (round = 0; round < 8; round++) {
+    DES_ROUND_BIG (left, right, subkeys, fval, work);
+    DES_ROUND_BIG (right, left, subkeys, fval, work);
+  }
+
+  DES_FP (left, right, work);
+  *block++ = right;
+  *block = left;
+}
+
+#ifndef DES_NO_DES3
+/* DES3Function on the merged tables.
+ */
+static void DES3FunctionBig (UInt32 *block, UInt32 (*subkeys)[32])
+{
+  UInt32 fval, work, right, left, *keys;
+  int pass, round;
+
+  left = block[0];
+  right = block[1];
+  DES_IP (left, right, work);
+
+  for (pass = 0; pass < 3; pass++) {
+    keys = subkeys[pass];
+    for (round = 0; round < 8; round++) {
+      DES_ROUND_BIG (left, right, keys, fval, work);
+      DES_ROUND_BIG (right, left, keys, fval, work);
+    }
+    if (pass < 2) {
+      work = left;
+      left = right;
+      right = work;
+    }
+  }
+
+  DES_FP (left, right, work);
+  *block++ = right;
+  *block = left;
+}
+#endif
+#endif
+
+#if !defined(DES_NO_OFB) || !defined(DES_NO_DESX)
+static void DESRoundsBig (UInt32 *halves, UInt32 *subkeys)
+{
+  UInt32 fval, work, right, left;
+  int round;
+
+  left = halves[0];
+  right = halves[1];
+
+  for (round = 0; round < 8; round++) {
+    DES_ROUND_BIG (left, right, subkeys, fval, work);
+    DES_ROUND_BIG (right, left, subkeys, fval, work);
+  }
+
+  halves[0] = right;
+  halves[1] = left;
+}
+#endif
+#endif
+
+#ifndef DES_MINIMAL
+/* Bitsliced DES.  BS_KEY spreads one bit of a cooked subkey across every
+   lane, and BS_INPUT gathers the six S-box inputs that DESFunction would
+   cut out of its rotated work word: bit rb of the source half onwards,
+   xored with bit kb of the subkey word onwards.
+ */
+#define BS_KEY(k, b)	((DES_BS_WORD)0 - (DES_BS_WORD)(((k) >> (b)) & 1L))
+#define BS_INPUT(r, k, rb, kb) \
+  r[(rb) & 31] ^ BS_KEY (k, kb), r[((rb) + 1) & 31] ^ BS_KEY (k, (kb) + 1), \
+  r[((rb) + 2) & 31] ^ BS_KEY (k, (kb) + 2), r[((rb) + 3) & 31] ^ BS_KEY (k, (kb) + 3), \
+  r[((rb) + 4) & 31] ^ BS_KEY (k, (kb) + 4), r[((rb) + 5) & 31] ^ BS_KEY (k, (kb) + 5)
+
+static void DESBitsliceRound (DES_BS_WORD *out, DES_BS_WORD *in, UInt32 k0, UInt32 k1)
+{
+  DESBitsliceS7 (out, BS_INPUT (in, k0,  4,  0));
+  DESBitsliceS5 (out, BS_INPUT (in, k0, 12,  8));
+  DESBitsliceS3 (out, BS_INPUT (in, k0, 20, 16));
+  DESBitsliceS1 (out, BS_INPUT (in, k0, 28, 24));
+  DESBitsliceS8 (out, BS_INPUT (in, k1,  0,  0));
+  DESBitsliceS6 (out, BS_INPUT (in, k1,  8,  8));
+  DESBitsliceS4 (out, BS_INPUT (in, k1, 16, 16));
+  DESBitsliceS2 (out, BS_INPUT (in, k1, 24, 24));
+}
+
+/* Transposes a 32x32 bit matrix in place, so that bit c of row k
+   becomes bit k of row c.
+ */
+static void DESBitsliceTranspose (UInt32 *rows)
+{
+  UInt32 mask, t;
+  int j, k;
+
+  for (j = 16, mask = 0x0000ffffL; j != 0; j >>= 1, mask ^= (mask << j)) {
+    for (k = 0; k < 32; k = (k + j + 1) & ~j) {
+      t = ((rows[k] >> j) ^ rows[k + j]) & mask;
+      rows[k + j] ^= t;
+      rows[k] ^= (t << j);
+    }
+  }
+}
+
+/* Runs count packed blocks (at most DES_BS_LANES) through passes
+   consecutive DES operations (one for DES and DESX, three for DES3) in
+   place.  The result is identical to calling DESFunction on each block
+   with each subkeys[] in turn.  Between passes the inner FP/IP pair
+   reduces to swapping the halves, so it is done by swapping plane
+   pointers.  Unused lanes are zero and their results dropped; the work
+   is the same for any count, and no memory is indexed by block or key
+   data.
+ */
+static void DESBitslice (UInt32 *blocks, UInt32 (*subkeys)[32], int passes, int count)
+{
+  DES_BS_WORD planes[64], *left, *right, *half;
+  UInt32 rows[32], *keys, work, l, r;
+  int i, j, g, pass, round;
+
+  for (i = 0; i < count; i++) {
+    l = blocks[2*i];
+    r = blocks[2*i+1];
+    DES_IP (l, r, work);
+    blocks[2*i] = l;
+    blocks[2*i+1] = r;
+  }
+
+  for (i = 0; i < 64; i++)
+    planes[i] = 0;
+  for (g = 0; g < count; g += 32) {
+    for (j = 0; j < 2; j++) {
+      for (i = 0; i < 32; i++)
+        rows[i] = (g + i < count) ? blocks[2*(g+i)+j] : 0;
+      DESBitsliceTranspose (rows);
+      for (i = 0; i < 32; i++)
+        planes[32*j+i] |= (DES_BS_WORD)rows[i] << g;
+    }
+  }
+
+  left = planes;
+  right = planes + 32;
+  for (pass = 0; pass < passes; pass++) {
+    keys = subkeys[pass];
+    for (round = 0; round < 8; round++) {
+      DESBitsliceRound (left, right, keys[0], keys[1]);
+      DESBitsliceRound (right, left, keys[2], keys[3]);
+      keys += 4;
+    }
+    if (pass + 1 < passes) {
+      half = left;
+      left = right;
+      right = half;
+    }
+  }
+
+  for (g = 0; g < count; g += 32) {
+    for (j = 0; j < 2; j++) {
+      half = j ? right : left;
+      for (i = 0; i < 32; i++)
+        rows[i] = (UInt32)(half[i] >> g);
+      DESBitsliceTranspose (rows);
+      for (i = 0; i < 32 && g + i < count; i++)
+        blocks[2*(g+i)+j] = rows[i];
+    }
+  }
+
+  for (i = 0; i < count; i++) {
+    l = blocks[2*i];
+    r = blocks[2*i+1];
+    DES_FP (l, r, work);
+    blocks[2*i] = r;
+    blocks[2*i+1] = l;
+  }
+}
+
+#if !defined(DES_NO_OFB) || !defined(DES_NO_DESX)
+/* DES_ROUNDS for bitsliced contexts: the bitsliced engine has no
+   IP-domain entry, so the block leaves the domain and comes back.
+ */
+static void DESRoundsBitslice (UInt32 *halves, UInt32 (*subkeys)[32], int passes)
+{
+  UInt32 block[2], work;
+
+  DES_FROM_IP (block, halves, work);
+  DESBitslice (block, subkeys, passes, 1);
+  DES_TO_IP (halves, block, work);
+}
+#endif
+
+/* Runs count packed blocks (at most DES_MB_LANES) through passes
+   consecutive DES operations in place, using the same SP-table rounds as
+   DESFunction.  Each round is a loop across the blocks, so the lookups of
+   independent blocks overlap instead of waiting on one dependency chain;
+   compilers that vectorize gathers can turn each loop into one.
+ */
+static void DESFunctionBlocks (UInt32 *blocks, UInt32 (*subkeys)[32], int passes, int count)
+{
+  UInt32 left[DES_MB_LANES], right[DES_MB_LANES], *keys, *src, *dst;
+  UInt32 fval, work;
+  int i, pass, round;
+
+  for (i = 0; i < count; i++) {
+    left[i] = blocks[2*i];
+    right[i] = blocks[2*i+1];
+    DES_IP (left[i], right[i], work);
+  }
+
+  for (pass = 0; pass < passes; pass++) {
+    keys = subkeys[pass];
+    for (round = 0; round < 16; round++) {
+      src = (round & 1) ? left : right;
+      dst = (round & 1) ? right : left;
+      for (i = 0; i < count; i++) {
+        work  = src[i];
+        fval  = (work << 28) | (work >> 4);
+        fval ^= keys[0];
+        work ^= keys[1];
+        dst[i] ^= SP7[ fval        & 0x3fL]
+                | SP5[(fval >>  8) & 0x3fL]
+                | SP3[(fval >> 16) & 0x3fL]
+                | SP1[(fval >> 24) & 0x3fL]
+                | SP8[ work        & 0x3fL]
+                | SP6[(work >>  8) & 0x3fL]
+                | SP4[(work >> 16) & 0x3fL]
+                | SP2[(work >> 24) & 0x3fL];
+      }
+      keys += 2;
+    }
+
+    /* As in DESBitslice, the inner FP/IP pair just swaps the halves.
+     */
+    if (pass + 1 < passes) {
+      for (i = 0; i < count; i++) {
+        work = left[i];
+        left[i] = right[i];
+        right[i] = work;
+      }
+    }
+  }
+
+  for (i = 0; i < count; i++) {
+    DES_FP (left[i], right[i], work);
+    blocks[2*i] = right[i];
+    blocks[2*i+1] = left[i];
+  }
+}
+
+/* Two and four packed blocks through passes consecutive DES operations,
+   as DESFunction does them but with the rounds of the blocks interleaved
+   in locals.  The chains are independent, so a superscalar core can
+   overlap their table lookups; unlike DESFunctionBlocks there are no
+   per-lane arrays, which keeps everything in registers on targets with
+   enough of them.
+ */
+static void DESFunction2 (UInt32 *blocks, UInt32 (*subkeys)[32], int passes)
+{
+  UInt32 left0, right0, left1, right1, fval0, fval1, work0, work1, *keys;
+  int pass, round;
+
+  left0 = blocks[0];
+  right0 = blocks[1];
+  left1 = blocks[2];
+  right1 = blocks[3];
+  DES_IP (left0, right0, work0);
+  DES_IP (left1, right1, work1);
+
+  for (pass = 0; pass < passes; pass++) {
+    keys = subkeys[pass];
+    for (round = 0; round < 8; round++) {
+      DES_ROUND_KEYS (left0, right0, keys[0], keys[1], fval0, work0);
+      DES_ROUND_KEYS (left1, right1, keys[0], keys[1], fval1, work1);
+      DES_ROUND_KEYS (right0, left0, keys[2], keys[3], fval0, work0);
+      DES_ROUND_KEYS (right1, left1, keys[2], keys[3], fval1, work1);
+      keys += 4;
+    }
+    if (pass + 1 < passes) {
+      work0 = left0; left0 = right0; right0 = work0;
+      work1 = left1; left1 = right1; right1 = work1;
+    }
+  }
+
+  DES_FP (left0, right0, work0);
+  DES_FP (left1, right1, work1);
+  blocks[0] = right0;
+  blocks[1] = left0;
+  blocks[2] = right1;
+  blocks[3] = left1;
+}
+
+static void DESFunction4 (UInt32 *blocks, UInt32 (*subkeys)[32], int passes)
+{
+  UInt32 left0, right0, left1, right1, left2, right2, left3, right3;
+  UInt32 fval0, fval1, fval2, fval3, work0, work1, work2, work3, *keys;
+  int pass, round;
+
+  left0 = blocks[0];
+  right0 = blocks[1];
+  left1 = blocks[2];
+  right1 = blocks[3];
+  left2 = blocks[4];
+  right2 = blocks[5];
+  left3 = blocks[6];
+  right3 = blocks[7];
+  DES_IP (left0, right0, work0);
+  DES_IP (left1, right1, work1);
+  DES_IP (left2, right2, work2);
+  DES_IP (left3, right3, work3);
+
+  for (pass = 0; pass < passes; pass++) {
+    keys = subkeys[pass];
+    for (round = 0; round < 8; round++) {
+      DES_ROUND_KEYS (left0, right0, keys[0], keys[1], fval0, work0);
+      DES_ROUND_KEYS (left1, right1, keys[0], keys[1], fval1, work1);
+      DES_ROUND_KEYS (left2, right2, keys[0], keys[1], fval2, work2);
+      DES_ROUND_KEYS (left3, right3, keys[0], keys[1], fval3, work3);
+      DES_ROUND_KEYS (right0, left0, keys[2], keys[3], fval0, work0);
+      DES_ROUND_KEYS (right1, left1, keys[2], keys[3], fval1, work1);
+      DES_ROUND_KEYS (right2, left2, keys[2], keys[3], fval2, work2);
+      DES_ROUND_KEYS (right3, left3, keys[2], keys[3], fval3, work3);
+      keys += 4;
+    }
+    if (pass + 1 < passes) {
+      work0 = left0; left0 = right0; right0 = work0;
+      work1 = left1; left1 = right1; right1 = work1;
+      work2 = left2; left2 = right2; right2 = work2;
+      work3 = left3; left3 = right3; right3 = work3;
+    }
+  }
+
+  DES_FP (left0, right0, work0);
+  DES_FP (left1, right1, work1);
+  DES_FP (left2, right2, work2);
+  DES_FP (left3, right3, work3);
+  blocks[0] = right0;
+  blocks[1] = left0;
+  blocks[2] = right1;
+  blocks[3] = left1;
+  blocks[4] = right2;
+  blocks[5] = left2;
+  blocks[6] = right3;
+  blocks[7] = left3;
+}
+
+/* Processes one batch of count blocks for the ECB and CBC-decrypt loops:
+   a full DES_BS_LANES batch is bitsliced, 2 and 4 blocks use the
+   interleaved scalar kernels, anything else the lane-loop table kernel.
+   DES_OPT_CONSTTIME contexts bitslice every batch.  pre and post are
+   whiteners xored in before and after the cipher (NULL for none); chain
+   is the CBC register to decrypt against, advanced to the last
+   ciphertext block (NULL for none); stream writes the output with
+   non-temporal stores where the host has them.
+ */
+static void DESBatch (DES_CTX *context, unsigned char *output, unsigned char *input, int count, UInt32 *pre, UInt32 *post, int passes, UInt32 *chain, int stream)
+{
+  UInt32 batch[2*DES_BS_LANES], previous[2];
+  int j;
+
+  PackBlocks (batch, input, count);
+  if (pre) {
+    for (j = 0; j < count; j++) {
+      batch[2*j] ^= pre[0];
+      batch[2*j+1] ^= pre[1];
+    }
+  }
+
+  if (count == DES_BS_LANES || (context->options & DES_OPT_CONSTTIME))
+    DESBitslice (batch, context->subkeys, passes, count);
+  else if (count == 4)
+    DESFunction4 (batch, context->subkeys, passes);
+  else if (count == 2)
+    DESFunction2 (batch, context->subkeys, passes);
+  else
+    DESFunctionBlocks (batch, context->subkeys, passes, count);
+
+  for (j = 0; j < count; j++) {
+    if (post) {
+      batch[2*j] ^= post[0];
+      batch[2*j+1] ^= post[1];
+    }
+  }
+
+  /* Every ciphertext block is read before any output is written, so
+     in-place calls (output == input) still chain correctly.
+   */
+  if (chain) {
+    for (j = count - 1; j > 0; j--) {
+      Pack (previous, &input[8*(j-1)]);
+      batch[2*j] ^= previous[0];
+      batch[2*j+1] ^= previous[1];
+    }
+    batch[0] ^= chain[0];
+    batch[1] ^= chain[1];
+    Pack (chain, &input[8*(count-1)]);
+  }
+
+#ifdef DES_STREAM_STORES
+  if (stream) {
+    UnpackBlocksStream (output, batch, count);
+    return;
+  }
+#endif
+  UnpackBlocks (output, batch, count);
+}
+
+/* Front end for the ECB and CBC-decrypt loops.  Takes as many of the
+   blocks as the context's multi-block kernel can use, widest batch first,
+   and returns how many it processed; the caller finishes an odd last
+   block on its own, and all of them under DES_KERNEL_SCALAR.  Only
+   DES_KERNEL_BITSLICE takes full DES_BS_LANES batches.  Calls of
+   context->streamMin bytes or more stream (see DES_STREAM_AHEAD).
+ */
+static unsigned long DESMultiBlock (DES_CTX *context, unsigned char *output, unsigned char *input, unsigned long blocks, UInt32 *pre, UInt32 *post, int passes, UInt32 *chain)
+{
+  unsigned long done, ahead;
+  int count, wide, stream;
+
+  wide = DES_BITSLICED (context, DES_CLASS_MULTI);
+  if (!wide && !DES_KERNEL_IS (context, DES_CLASS_MULTI, DES_KERNEL_INTERLEAVED))
+    return 0;
+  stream = (context->streamMin && blocks >= context->streamMin / 8);
+
+  for (done = 0; blocks - done >= DES_MB_MIN; done += count) {
+    if (wide && blocks - done >= DES_BS_LANES)
+      count = DES_BS_LANES;
+    else if (blocks - done >= DES_MB_LANES)
+      count = DES_MB_LANES;
+    else if (blocks - done >= 4)
+      count = 4;
+    else
+      count = 2;
+    if (stream) {
+      for (ahead = 8*done + DES_STREAM_AHEAD; ahead < 8*(done + count) + DES_STREAM_AHEAD && ahead < 8*blocks; ahead += DES_CACHE_LINE)
+        DES_PREFETCH (&input[ahead]);
+    }
+    DESBatch (context, &output[8*done], &input[8*done], count, pre, post, passes, chain, stream);
+  }
+#ifdef DES_STREAM_STORES
+  if (stream)
+    _mm_sfence ();
+#endif
+  return done;
+}
+#endif
+
+/* Key schedule for the context's type in one direction: the single DES
+   schedule, or for DES3 the three E-D-E schedules in the order the
+   direction runs them.  With a cache, a recent schedule for the same key
+   is copied instead and a new one is kept, replacing the least recently
+   used entry.
+ */
+static void DESScheduleKeys (DES_CTX *context, unsigned char *key, int direction, DESKeyCache *cache)
+{
+  DESKeyCacheEntry *entry, *victim;
+  UInt32 tag;
+  int i, length, passes;
+
+  length = (context->destype == DES3) ? 24 : 8;
+  passes = (context->destype == DES3) ? 3 : 1;
+
+  if (cache == DES_KEYS_BATCHED)
+    return;
+
+  victim = NULL;
+  tag = 0;
+  if (cache && cache->limit) {
+    tag = DESKeyCacheTag (cache, key, length, context->destype, direction);
+    cache->clock++;
+    for (i = 0; i < cache->limit; i++) {
+      entry = &cache->entry[i];
+      if (entry->tag == tag && entry->destype == context->destype && entry->direction == direction &&
+          !DESKeyDiffers (entry->key, key, length)) {
+        MemMove (context->subkeys, entry->subkeys, passes * sizeof (context->subkeys[0]));
+        entry->used = cache->clock;
+        cache->hits++;
+        return;
+      }
+      if (!victim || !entry->tag || (victim->tag && entry->used < victim->used))
+        victim = entry;
+    }
+    cache->misses++;
+  }
+
+  if (passes == 3) {
+    DESKey (context->subkeys[0], direction ? key : &key[16], direction, context->options);
+    DESKey (context->subkeys[1], &key[8], !direction, context->options);
+    DESKey (context->subkeys[2], direction ? &key[16] : key, direction, context->options);
+  }
+  else
+    DESKey (context->subkeys[0], key, direction, context->options);
+
+  if (victim) {
+    victim->tag = tag;
+    victim->used = cache->clock;
+    victim->destype = context->destype;
+    victim->direction = direction;
+    MemMove (victim->key, key, length);
+    MemMove (victim->subkeys, context->subkeys, passes * sizeof (context->subkeys[0]));
+  }
+}
+
+/* Direction of the schedule a context needs: the feedback and counter
+   modes run the cipher forwards either way, ECB and CBC in the
+   context's direction.
+ */
+#define DES_SCHEDULE_DIRECTION(context) \
+  (((context)->desmode == ECB || (context)->desmode == CBC) ? (context)->encrypt : ENCRYPT)
+
+#ifndef DES_MINIMAL
+/* One pass of the schedules of count contexts (at most DES_KEY_LANES),
+   from the 8 key bytes at offset in each length-byte key, all at once.
+   The keys are turned into 64 bit planes, a word per key bit with a bit
+   per key, so PC1, the rotations, PC2 and CookKey's regrouping only
+   choose which plane feeds each bit of a cooked subkey word; one
+   transpose per word then gives every key's copy of it.  No step reads
+   a table or branches on a key bit.
+ */
+static void DESScheduleBatch (DES_CTX *contexts, unsigned char *keys, int length, int count, int pass, int offset, int encrypt)
+{
+  UInt32 planes[64], words[32];
+  unsigned char *key;
+  int i, j, k, l, p, w, group, half;
+
+  for (half = 0; half < 2; half++) {
+    for (k = 0; k < 32; k++) {
+      words[k] = 0;
+      if (k < count) {
+        key = &keys[length*k + offset + 4*half];
+        words[k] = ((UInt32)key[0] << 24) | ((UInt32)key[1] << 16) | ((UInt32)key[2] << 8) | (UInt32)key[3];
+      }
+    }
+    DESTranspose32 (words);
+    MemMove (&planes[32*half], words, sizeof (words));
+  }
+
+  /* Cooked word w of round i holds four 6-bit groups, each the top 2 of
+     a byte clear: raw word 2i for the first two groups and 2i + 1 for
+     the others, bits 0-5 and 12-17 of the raw word for w = 0, 6-11 and
+     18-23 for w = 1, with raw bits counted as DESKey's BIG_BYTE does.
+   */
+  for (i = 0; i < 16; i++)
+    for (w = 0; w < 2; w++) {
+      for (k = 0; k < 32; k++)
+        words[k] = 0;
+      for (group = 0; group < 4; group++)
+        for (k = 0; k < 6; k++) {
+          j = k + 6 * (w + 2 * (group & 1));
+          p = PC2[j + 24 * (group >> 1)];
+          l = p + TOTAL_ROTATIONS[i];
+          if ((p < 28) ? (l >= 28) : (l >= 56))
+            l -= 28;
+          words[2 + 8*group + k] = planes[PC1[l]];
+        }
+      DESTranspose32 (words);
+      for (k = 0; k < count; k++)
+        contexts[k].subkeys[pass][(encrypt ? 2*i : 30 - 2*i) + w] = words[k];
+    }
+}
+
+/* Transposes a 32 by 32 bit matrix in place, bits counted from the most
+   significant: bit j of word i trades places with bit i of word j.
+ */
+static void DESTranspose32 (UInt32 *a)
+{
+  UInt32 m, t;
+  int j, k;
+
+  m = 0x0000ffffL;
+  for (j = 16; j; j >>= 1, m ^= m << j)
+    for (k = 0; k < 32; k = (k + j + 1) & ~j) {
+      t = (a[k] ^ (a[k + j] >> j)) & m;
+      a[k] ^= t;
+      a[k + j] ^= t << j;
+    }
+}
+#endif
+
+/* Turns the context's schedule around in place.  A decryption schedule is
+   the encryption one with its rounds in the opposite order and, for DES3,
+   its three passes too, so this costs a few dozen swaps, not a DESKey.
+ */
+static void DESReverseSchedule (DES_CTX *context)
+{
+  UInt32 swap, *low, *high;
+  int pass, passes, i;
+
+  passes = (context->destype == DES3) ? 3 : 1;
+  for (pass = 0; pass < passes; pass++) {
+    low = context->subkeys[pass];
+    high = &context->subkeys[pass][30];
+    for (i = 0; i < 8; i++, low += 2, high -= 2) {
+      swap = low[0]; low[0] = high[0]; high[0] = swap;
+      swap = low[1]; low[1] = high[1]; high[1] = swap;
+    }
+  }
+  if (passes == 3) {
+    for (i = 0; i < 32; i++) {
+      swap = context->subkeys[0][i];
+      context->subkeys[0][i] = context->subkeys[2][i];
+      context->subkeys[2][i] = swap;
+    }
+  }
+}
+
+/* Turns a bidirectional context around: the schedule is reversed when
+   the mode's schedule direction changes with it, and DESX swaps its
+   whiteners to match.
+ */
+static void DESSetDirection (DES_CTX *context, int encrypt)
+{
+  int scheduled;
+
+  if (context->encrypt == encrypt)
+    return;
+  scheduled = DES_SCHEDULE_DIRECTION (context);
+  context->encrypt = encrypt;
+  if (DES_SCHEDULE_DIRECTION (context) != scheduled)
+    DESReverseSchedule (context);
+#ifndef DES_NO_DESX
+  if (context->destype == DESX)
+    DESXWhiteners (context);
+#endif
+}
+
+/* Keyed hash of a cache lookup, never 0 (the empty tag).  Mixing the
+   secret in first keeps the tags from being matched against a table of
+   known keys.
+ */
+static UInt32 DESKeyCacheTag (DESKeyCache *cache, unsigned char *key, int length, int destype, int direction)
+{
+  UInt32 hash;
+  int i;
+
+  hash = cache->hashKey[0] ^ ((UInt32)destype << 1) ^ (UInt32)direction;
+  for (i = 0; i < length; i++) {
+    hash = (hash ^ key[i]) * 0x01000193L;
+    hash ^= hash >> 15;
+  }
+  hash ^= cache->hashKey[1];
+  hash *= 0x2c1b3c6dL;
+  hash ^= hash >> 16;
+  return hash ? hash : 1;
+}
+
+/* Nonzero when two keys differ.  Every byte is looked at whatever the
+   first difference, unlike MemCmp, so the time taken says nothing about
+   how much of a cached key matches.
+ */
+static int DESKeyDiffers (unsigned char *a, unsigned char *b, int length)
+{
+  unsigned char diff;
+  int i;
+
+  diff = 0;
+  for (i = 0; i < length; i++)
+    diff |= a[i] ^ b[i];
+  return diff;
+}
+
+/* Sets up an empty cache of DES_KEY_CACHE_SIZE entries with a hash secret
+   derived from seed.
+ */
+void DESKeyCacheInit (DESKeyCache *cache, UInt32 seed)
+{
+  MemSet (cache, sizeof (*cache), 0);
+  cache->hashKey[0] = seed * 0x9e3779b1L;
+  cache->hashKey[1] = (seed ^ 0x5bd1e995L) * 0x85ebca6bL;
+  cache->limit = DES_KEY_CACHE_SIZE;
+}
+
+/* Wipes every entry, keys and schedules alike; the counters and the
+   secret are kept.
+ */
+void DESKeyCacheFlush (DESKeyCache *cache)
+{
+  MemSet (cache->entry, sizeof (cache->entry), 0);
+}
+
+/* Whether this build carries the given type and mode; a profile that
+   leaves one out (DES_NO_DESX, DES_NO_CFB, ...) refuses it here rather
+   than producing a context that does nothing.
+ */
+static int DESSupported (int destype, int desmode)
+{
+  switch (destype) {
+    case DES:
+      break;
+#ifndef DES_NO_DESX
+    case DESX:
+      break;
+#endif
+#ifndef DES_NO_DES3
+    case DES3:
+      break;
+#endif
+    default:
+      return 0;
+  }
+  switch (desmode) {
+#ifndef DES_NO_ECB
+    case ECB:
+#endif
+#ifndef DES_NO_CBC
+    case CBC:
+#endif
+#ifndef DES_NO_CFB
+    case CFB:
+#endif
+#ifndef DES_NO_OFB
+    case OFBFIPS81:
+    case OFBISO:
+#endif
+#ifndef DES_NO_CTR
+    case CTR:
+#endif
+      return 1;
+  }
+  return 0;
+}
+
+/* Whether this build carries the kernel for the class: the tables in
+   every build, the merged tables with DES_BIG_SP, and the interleaved and
+   bitsliced engines outside DES_MINIMAL.
+ */
+int DESKernelValid (int opclass, int kernel)
+{
+  switch (kernel) {
+    case DES_KERNEL_SCALAR:
+      return (opclass >= 0 && opclass < DES_CLASSES);
+#ifdef DES_BIG_SP
+    case DES_KERNEL_BIGSP:
+      return (opclass == DES_CLASS_SINGLE || opclass == DES_CLASS_DES3);
+#endif
+#ifndef DES_MINIMAL
+    case DES_KERNEL_INTERLEAVED:
+      return (opclass == DES_CLASS_MULTI);
+    case DES_KERNEL_BITSLICE:
+      return (opclass >= 0 && opclass < DES_CLASSES);
+#endif
+  }
+  return 0;
+}
+
 int Initialize_DES(unsigned char * key, unsigned char * iv, int desmode, int destype, int encrypt, DES_CTX * context)
 {
+return Initialize_DESCached(key, iv, desmode, destype, encrypt, DES_DEFAULT_OPTIONS, context, NULL);
+}
+
+/* Initialize_DES with the context's DES_OPT_* options in place of
+   DES_DEFAULT_OPTIONS before the key is scheduled, so that the first
+   schedule of a DES_OPT_CONSTTIME context is already the masked one.
+ */
+int Initialize_DESOptions(unsigned char * key, unsigned char * iv, int desmode, int destype, int encrypt, int options, DES_CTX * context)
+{
+return Initialize_DESCached(key, iv, desmode, destype, encrypt, options, context, NULL);
+}
+
+/* Initialize_DESOptions that takes the key schedule from cache when it
+   can and leaves the new schedule there when it cannot; NULL for no
+   cache.
+ */
+int Initialize_DESCached(unsigned char * key, unsigned char * iv, int desmode, int destype, int encrypt, int options, DES_CTX * context, DESKeyCache * cache)
+{
+if (!DESSupported(destype, desmode))
+	return DESErrParam;
+#ifdef DES_MINIMAL
+if (options & DES_OPT_CONSTTIME)
+	return DESErrParam;
+#endif
+/* A bidirectional context is scheduled for encryption and turned around
+   by DESSetDirection when Decrypt_DES first needs it.
+ */
+context->bidirectional = (encrypt == BIDIRECTIONAL);
+if (context->bidirectional)
+	encrypt = ENCRYPT;
 context->destype = destype;
 context->desmode = desmode;
+context->n = 64;
+context->keystreamUsed = 0;
+context->blockBits = 0;
+context->ahead = NULL;
+context->aheadSize = 0;
+context->aheadStart = 0;
+context->aheadCount = 0;
+context->counterBits = 64;
+context->threads = DES_DEFAULT_THREADS;
+context->options = options;
+context->streamMin = DES_DEFAULT_STREAM_MIN;
+context->kernel[DES_CLASS_SINGLE] = DES_DEFAULT_KERNEL;
+context->kernel[DES_CLASS_MULTI] = DES_DEFAULT_MULTI_KERNEL;
+context->kernel[DES_CLASS_DES3] = DES_DEFAULT_KERNEL;
+#ifdef DES_BIG_SP
+DESBigSPReady();
+#endif
 switch(destype){
 				case DES:
-						DES_Init(context, key, iv, encrypt);break;
+						DES_Init(context, key, iv, encrypt, cache);break;
+#ifndef DES_NO_DESX
 				case DESX: 
-						DESX_Init(context, key, iv, encrypt);break;
+						DESX_Init(context, key, iv, encrypt, cache);break;
+#endif
+#ifndef DES_NO_DES3
 				case DES3: 
-						DES3_Init(context, key, iv, encrypt);break;	
+						DES3_Init(context, key, iv, encrypt, cache);break;	
+#endif
 				}
 			return 0;		
 }
 
+/* A new IV for an existing context; the key schedule is untouched and
+   DES_Restart rewinds to this IV from now on.
+ */
+int SetIV_DES(DES_CTX * context, unsigned char * iv)
+{
+Pack(context->iv, iv);
+context->originalIV[0] = context->iv[0];
+context->originalIV[1] = context->iv[1];
+context->keystreamUsed = 0;
+context->blockBits = 0;
+context->aheadCount = 0;
+return 0;
+}
+
+/* A new key for an existing context, keeping its type, mode, direction,
+   options and chaining state.  key is laid out as for Initialize_DES.
+ */
+int Rekey_DES(DES_CTX * context, unsigned char * key, DESKeyCache * cache)
+{
+if (context->aheadCount)
+	return DESErrLookahead;
+#ifndef DES_NO_DESX
+if (context->destype == DESX) {
+	Pack(context->inputWhitener, key + 8);
+	Pack(context->outputWhitener, key + 16);
+	DESXWhiteners(context);
+}
+#endif
+DESScheduleKeys(context, key, DES_SCHEDULE_DIRECTION(context), cache);
+context->keystreamUsed = 0;
+context->blockBits = 0;
+context->aheadCount = 0;
+return 0;
+}
+
+/* Moves an existing context to another mode of the same type, keeping
+   its key and IV.  The schedule is reversed in place when the new mode
+   runs the cipher the other way (ECB or CBC decryption to or from a
+   feedback mode), so no mode change needs a DESKey run.
+ */
+int SetMode_DES(DES_CTX * context, int desmode)
+{
+int scheduled;
+
+if (!DESSupported(context->destype, desmode))
+	return DESErrParam;
+if (context->aheadCount)
+	return DESErrLookahead;
+scheduled = DES_SCHEDULE_DIRECTION(context);
+context->desmode = desmode;
+context->keystreamUsed = 0;
+context->blockBits = 0;
+context->aheadCount = 0;
+if (DES_SCHEDULE_DIRECTION(context) != scheduled)
+	DESReverseSchedule(context);
+#ifndef DES_NO_DESX
+if (context->destype == DESX)
+	DESXWhiteners(context);
+#endif
+return 0;
+}
+
+/* Sets the CFB and OFB segment size, in bits.  Initialize_DES starts
+   every context at 64, a whole block per segment.  Like a new IV, key or
+   mode, it drops what is left of a segment a call stopped inside.
+ */
+int SetSegment_DES(DES_CTX * context, int n)
+{
+if ((n < 1) || (n > 64))
+	return DESErrParam;
+if (context->aheadCount)
+	return DESErrLookahead;
+context->n = n;
+context->keystreamUsed = 0;
+context->blockBits = 0;
+context->aheadCount = 0;
+return 0;
+}
+
+/* Gives an OFB context a ring of size bytes for keystream made ahead of
+   the data by FillLookahead_DES, or takes it away when buffer is NULL.
+   The caller owns the buffer and keeps it until the context is done or
+   the ring is taken away.
+
+   The register stands at the end of the ring, not at its head, so
+   keystream in the ring cannot simply be dropped: the data would skip
+   it and no peer without a ring could follow.  A new IV or a restart
+   rewinds the register and empties the ring.  A new key, mode, segment
+   size or ring is refused with DESErrLookahead while the ring holds
+   keystream; use it up or set the IV first.
+ */
+int SetLookahead_DES(DES_CTX * context, unsigned char * buffer, unsigned long size)
+{
+if (buffer && size && (context->desmode != OFBISO) && (context->desmode != OFBFIPS81))
+	return DESErrParam;
+if (context->aheadCount)
+	return DESErrLookahead;
+context->ahead = size ? buffer : NULL;
+context->aheadSize = buffer ? size : 0;
+context->aheadStart = 0;
+context->aheadCount = 0;
+return 0;
+}
+
+/* Makes up to len bytes of keystream into the free part of the ring and
+   leaves how many it made in *made.  OFB keystream depends on nothing but
+   the key and IV, so this runs whenever the caller has time, and
+   Encrypt_DES and Decrypt_DES then only xor what it left.  The context's
+   register and segment move on to the end of the ring.  A context that
+   is not OFB, has no ring or has a bad segment size gets DESErrParam.
+ */
+int FillLookahead_DES(DES_CTX * context, unsigned long len, unsigned long * made)
+{
+#ifndef DES_NO_OFB
+unsigned long tail, piece;
+
+*made = 0;
+if ((context->desmode != OFBISO) && (context->desmode != OFBFIPS81))
+	return DESErrParam;
+if (!context->ahead || !context->aheadSize)
+	return DESErrParam;
+if ((context->n < 1) || (context->n > 64))
+	return DESErrParam;
+*made = context->aheadSize - context->aheadCount;
+if (len < *made)
+	*made = len;
+while (len && (context->aheadCount < context->aheadSize)) {
+	tail = (context->aheadStart + context->aheadCount) % context->aheadSize;
+	piece = context->aheadSize - tail;
+	if (piece > context->aheadSize - context->aheadCount)
+		piece = context->aheadSize - context->aheadCount;
+	if (piece > len)
+		piece = len;
+	MemSet(context->ahead + tail, piece, 0);
+	DESFeedbackRun(context, context->ahead + tail, piece, context->destype, context->desmode);
+	context->aheadCount += piece;
+	len -= piece;
+}
+return 0;
+#else
+*made = 0;
+return DESErrParam;
+#endif
+}
+
+/* Sets the width of the CTR counter in bits: the low bits bits of the
+   IV count blocks, wrapping within themselves, and the bits above them
+   are a nonce that stays as it is.  Initialize_DES starts every context
+   at 64, the whole IV.  The counter carries on from where it stands.
+ */
+int SetCounter_DES(DES_CTX * context, int bits)
+{
+if ((bits < 1) || (bits > 64))
+	return DESErrParam;
+context->counterBits = bits;
+return 0;
+}
+
+/* Moves a CTR context to byte offset of the message that starts at its
+   IV, so the next call picks up there.  The counter is worked out from
+   the IV rather than stepped to, so a seek anywhere costs one cipher call
+   at most.
+ */
+int Seek_DES(DES_CTX * context, unsigned long offset)
+{
+#ifndef DES_NO_CTR
+if (context->desmode != CTR)
+	return DESErrParam;
+context->iv[0] = context->originalIV[0];
+context->iv[1] = context->originalIV[1];
+DESCounterAdd(context->iv, context->counterBits, offset / 8);
+context->keystreamUsed = 0;
+if (offset % 8) {
+	DESCounterKeystream(context, context->destype);
+	context->keystreamUsed = 8 * (int)(offset % 8);
+}
+return 0;
+#else
+return DESErrParam;
+#endif
+}
+
+/* Initialize_DES for count contexts at once, for key-ring loads.  keys
+   holds the keys back to back (8 bytes each for DES, 24 for DESX and
+   DES3) and ivs the 8-byte IVs; every context gets the same mode, type
+   and direction.  Each context is set up without its schedule, then
+   DESScheduleBatch makes the schedules DES_KEY_LANES keys at a time,
+   several times faster than the masked schedule key by key.  Where the
+   contexts may use the word-wide table schedule, which beats the
+   transposes, they get that one key at a time instead, as they always
+   do in DES_MINIMAL builds, whose stack DESScheduleBatch's frame would
+   outgrow.  The batch bypasses the key-schedule cache, which a run of
+   one-off keys would only flush.
+ */
+int Initialize_DESBatch(unsigned char * keys, unsigned char * ivs, int desmode, int destype, int encrypt, DES_CTX * contexts, unsigned long count)
+{
+unsigned long i;
+int length, direction;
+#ifndef DES_MINIMAL
+int lanes;
+#endif
+
+if (!DESSupported(destype, desmode))
+	return DESErrParam;
+if (!count)
+	return 0;
+length = (destype == DES) ? 8 : 24;
+for (i = 0; i < count; i++)
+	Initialize_DESCached(&keys[length*i], &ivs[8*i], desmode, destype, encrypt, DES_DEFAULT_OPTIONS, &contexts[i], DES_KEYS_BATCHED);
+direction = DES_SCHEDULE_DIRECTION(contexts);
+#if defined(DES_KEY_TABLES) || defined(DES_MINIMAL)
+if (!(contexts->options & DES_OPT_CONSTTIME)) {
+	for (i = 0; i < count; i++)
+		DESScheduleKeys(&contexts[i], &keys[length*i], direction, NULL);
+	return 0;
+}
+#endif
+#ifndef DES_MINIMAL
+for (i = 0; i < count; i += lanes) {
+	lanes = (count - i < DES_KEY_LANES) ? (int)(count - i) : DES_KEY_LANES;
+	if (destype == DES3) {
+		/* The E-D-E order of DESScheduleKeys. */
+		DESScheduleBatch(&contexts[i], &keys[length*i], length, lanes, 0, direction ? 0 : 16, direction);
+		DESScheduleBatch(&contexts[i], &keys[length*i], length, lanes, 1, 8, !direction);
+		DESScheduleBatch(&contexts[i], &keys[length*i], length, lanes, 2, direction ? 16 : 0, direction);
+	}
+	else
+		DESScheduleBatch(&contexts[i], &keys[length*i], length, lanes, 0, 0, direction);
+}
+#endif
+return 0;
+}
+
 int Decrypt_DES(DES_CTX *context , unsigned char * in, unsigned char * out, unsigned long size){
+int status = 0;
+
+#ifdef DES_MINIMAL
+/* Nothing in this profile keeps table reads independent of the key. */
+if (context->options & DES_OPT_CONSTTIME)
+	return DESErrParam;
+#endif
+if (context->bidirectional)
+	DESSetDirection(context, DECRYPT);
 switch(context->destype){
 				case DES: 
 					switch(context->desmode){
-						case ECB : 		DES_ECBUpdate(context, out, in, size);break;
-						case CBC : 		DES_CBCUpdate(context, out, in, size);break;
-						case CFB : 		DES_CFBUpdate(context, out, in, size);break;
-						case OFBFIPS81:	DES_OFBFIPS81Update(context, out, in, size);break;
-						case OFBISO :	DES_OFBISOUpdate(context, out, in, size);break;
+#ifndef DES_NO_ECB
+						case ECB : 		status = DES_ECBUpdate(context, out, in, size);break;
+#endif
+#ifndef DES_NO_CBC
+						case CBC : 		status = DES_CBCUpdate(context, out, in, size);break;
+#endif
+#ifndef DES_NO_CFB
+						case CFB : 		status = DES_CFBUpdate(context, out, in, size);break;
+#endif
+#ifndef DES_NO_OFB
+						case OFBFIPS81:	status = DES_OFBFIPS81Update(context, out, in, size);break;
+						case OFBISO :	status = DES_OFBISOUpdate(context, out, in, size);break;
+#endif
+#ifndef DES_NO_CTR
+						case CTR :	status = DES_CTRUpdate(context, out, in, size);break;
+#endif
 						}
 					break;
+#ifndef DES_NO_DESX
 				case DESX: 
 					switch(context->desmode){
-						case ECB :	DESX_ECBUpdate(context, out, in, size);break;
-						case CBC :	DESX_CBCUpdate(context, out, in, size);break;
-						case CFB :	DESX_CFBUpdate(context, out, in, size);break;
-						case OFBFIPS81:	DESX_OFBFIPS81Update(context, out, in, size);break;
-						case OFBISO :	DESX_OFBISOUpdate(context, out, in, size);break;
+#ifndef DES_NO_ECB
+						case ECB :	status = DESX_ECBUpdate(context, out, in, size);break;
+#endif
+#ifndef DES_NO_CBC
+						case CBC :	status = DESX_CBCUpdate(context, out, in, size);break;
+#endif
+#ifndef DES_NO_CFB
+						case CFB :	status = DESX_CFBUpdate(context, out, in, size);break;
+#endif
+#ifndef DES_NO_OFB
+						case OFBFIPS81:	status = DESX_OFBFIPS81Update(context, out, in, size);break;
+						case OFBISO :	status = DESX_OFBISOUpdate(context, out, in, size);break;
+#endif
+#ifndef DES_NO_CTR
+						case CTR :	status = DESX_CTRUpdate(context, out, in, size);break;
+#endif
 						}
 					break;
+#endif
+#ifndef DES_NO_DES3
 				case DES3: 
 					switch(context->desmode){
-						case ECB :	DES3_ECBUpdate(context, out, in, size);break;
-						case CBC :	DES3_CBCUpdate(context, out, in, size);break;
-						case CFB :	DES3_CFBUpdate(context, out, in, size);break;
-						case OFBFIPS81:	DES_OFBFIPS81Update(context, out, in, size);break;
-						case OFBISO :	DES_OFBISOUpdate(context, out, in, size);break;
+#ifndef DES_NO_ECB
+						case ECB :	status = DES3_ECBUpdate(context, out, in, size);break;
+#endif
+#ifndef DES_NO_CBC
+						case CBC :	status = DES3_CBCUpdate(context, out, in, size);break;
+#endif
+#ifndef DES_NO_CFB
+						case CFB :	status = DES3_CFBUpdate(context, out, in, size);break;
+#endif
+#ifndef DES_NO_OFB
+						case OFBFIPS81:	status = DES3_OFBFIPS81Update(context, out, in, size);break;
+						case OFBISO :	status = DES3_OFBISOUpdate(context, out, in, size);break;
+#endif
+#ifndef DES_NO_CTR
+						case CTR :	status = DES3_CTRUpdate(context, out, in, size);break;
+#endif
 						}
 					break;	
+#endif
 				}
-			return 0;		
+			return status ? DESErrParam : 0;
 }
 
 int Encrypt_DES(DES_CTX * context, unsigned char * in, unsigned char * out, unsigned long size)
 {
+int status = 0;
+
+#ifdef DES_MINIMAL
+/* Nothing in this profile keeps table reads independent of the key. */
+if (context->options & DES_OPT_CONSTTIME)
+	return DESErrParam;
+#endif
+if (context->bidirectional)
+	DESSetDirection(context, ENCRYPT);
 switch(context->destype){
 				case DES: 
 					switch(context->desmode){
-						case ECB : 	DES_ECBUpdate(context, out, in, size);break;
-						case CBC : 	DES_CBCUpdate(context, out, in, size);break;
-						case CFB : 	DES_CFBUpdate(context, out, in, size);break;
-						case OFBFIPS81:	DES_OFBFIPS81Update(context, out, in, size);break;
-						case OFBISO :	DES_OFBISOUpdate(context, out, in, size);break;
+#ifndef DES_NO_ECB
+						case ECB : 	status = DES_ECBUpdate(context, out, in, size);break;
+#endif
+#ifndef DES_NO_CBC
+						case CBC : 	status = DES_CBCUpdate(context, out, in, size);break;
+#endif
+#ifndef DES_NO_CFB
+						case CFB : 	status = DES_CFBUpdate(context, out, in, size);break;
+#endif
+#ifndef DES_NO_OFB
+						case OFBFIPS81:	status = DES_OFBFIPS81Update(context, out, in, size);break;
+						case OFBISO :	status = DES_OFBISOUpdate(context, out, in, size);break;
+#endif
+#ifndef DES_NO_CTR
+						case CTR :	status = DES_CTRUpdate(context, out, in, size);break;
+#endif
 						}
 					break;
+#ifndef DES_NO_DESX
 				case DESX: 
 					switch(context->desmode){
-						case ECB :	DESX_ECBUpdate(context, out, in, size);break;
-						case CBC :	DESX_CBCUpdate(context, out, in, size);break;
-						case CFB :	DESX_CFBUpdate(context, out, in, size);break;
-						case OFBFIPS81:	DESX_OFBFIPS81Update(context, out, in, size);break;
-						case OFBISO :	DESX_OFBISOUpdate(context, out, in, size);break;
+#ifndef DES_NO_ECB
+						case ECB :	status = DESX_ECBUpdate(context, out, in, size);break;
+#endif
+#ifndef DES_NO_CBC
+						case CBC :	status = DESX_CBCUpdate(context, out, in, size);break;
+#endif
+#ifndef DES_NO_CFB
+						case CFB :	status = DESX_CFBUpdate(context, out, in, size);break;
+#endif
+#ifndef DES_NO_OFB
+						case OFBFIPS81:	status = DESX_OFBFIPS81Update(context, out, in, size);break;
+						case OFBISO :	status = DESX_OFBISOUpdate(context, out, in, size);break;
+#endif
+#ifndef DES_NO_CTR
+						case CTR :	status = DESX_CTRUpdate(context, out, in, size);break;
+#endif
 						}
 					break;
+#endif
+#ifndef DES_NO_DES3
 				case DES3: 
 					switch(context->desmode){
-						case ECB :	DES3_ECBUpdate(context, out, in, size);break;
-						case CBC :	DES3_CBCUpdate(context, out, in, size);break;
-						case CFB :	DES3_CFBUpdate(context, out, in, size);break;
-						case OFBFIPS81:	DES_OFBFIPS81Update(context, out, in, size);break;
-						case OFBISO :	DES_OFBISOUpdate(context, out, in, size);break;
+#ifndef DES_NO_ECB
+						case ECB :	status = DES3_ECBUpdate(context, out, in, size);break;
+#endif
+#ifndef DES_NO_CBC
+						case CBC :	status = DES3_CBCUpdate(context, out, in, size);break;
+#endif
+#ifndef DES_NO_CFB
+						case CFB :	status = DES3_CFBUpdate(context, out, in, size);break;
+#endif
+#ifndef DES_NO_OFB
+						case OFBFIPS81:	status = DES3_OFBFIPS81Update(context, out, in, size);break;
+						case OFBISO :	status = DES3_OFBISOUpdate(context, out, in, size);break;
+#endif
+#ifndef DES_NO_CTR
+						case CTR :	status = DES3_CTRUpdate(context, out, in, size);break;
+#endif
 						}
 					break;	
+#endif
 				}
-			return 0;	
+			return status ? DESErrParam : 0;
 			}
\ No newline at end of file
@@ -34,6 +34,61 @@
 
 #pragma once
 
+// Build profile.  DES_MINIMAL builds a small library for memory-tight
+// devices: packed S-boxes with the P permutation done on the fly, no
+// multi-block or bitsliced kernels, and no big-table or constant-time
+// options; Initialize_DESOptions, Encrypt_DES and Decrypt_DES return
+// DESErrParam for a context with DES_OPT_CONSTTIME set.  Nothing in it
+// needs a deeper stack frame than DESKey's, so Initialize_DESBatch
+// schedules key by key there.  In any profile DES_NO_DESX, DES_NO_DES3, DES_NO_ECB,
+// DES_NO_CBC, DES_NO_CFB, DES_NO_OFB (both OFB variants) and DES_NO_CTR
+// leave a type or mode out; Initialize_DES returns DESErrParam for what is
+// not built.  DES_THREADS, for hosts with POSIX threads, splits large CTR
+// and CBC-decrypt calls across worker threads (DES_CTX.threads).
+#ifdef DES_MINIMAL
+#if defined(DES_BIG_SP) || defined(DES_CONSTANT_TIME) || defined(DES_CXX_CORE)
+#error "DES_MINIMAL cannot be combined with DES_BIG_SP, DES_CONSTANT_TIME or DES_CXX_CORE"
+#endif
+#if (DES_DEFAULT_OPTIONS) & DES_OPT_CONSTTIME
+#error "DES_MINIMAL cannot default to DES_OPT_CONSTTIME"
+#endif
+#define DES_COMPACT_TABLES	1
+#define DES_NO_PACK64		1
+#endif
+
+// Key-schedule cache.  DESInitialize keeps the cooked subkeys of the last
+// few keys it scheduled, so a context for a recent key is a copy instead of
+// a DESKey run.  Entries are found by a hash keyed with a secret picked at
+// DESOpen and confirmed against the stored key bytes; the least recently
+// used entry is replaced.  DESFlushKeyCache and the last DESClose wipe it.
+#ifndef DES_KEY_CACHE_SIZE
+#ifdef DES_MINIMAL
+#define DES_KEY_CACHE_SIZE	2
+#else
+#define DES_KEY_CACHE_SIZE	8
+#endif
+#endif
+
+typedef struct
+{
+	UInt32		tag;					// keyed hash of key, type and direction; 0 when empty
+	UInt32		used;					// DESKeyCache.clock at the last hit or fill
+	int			destype;
+	int			direction;				// ENCRYPT or DECRYPT schedule
+	unsigned char key[24];				// 8 bytes, or 24 for DES3
+	UInt32		subkeys[3][32];
+} DESKeyCacheEntry;
+
+typedef struct
+{
+	UInt32		hashKey[2];				// secret for the tag hash
+	UInt32		clock;					// ticks once per lookup, for LRU
+	UInt32		hits;
+	UInt32		misses;
+	int			limit;					// entries in use at most, 0 to DES_KEY_CACHE_SIZE
+	DESKeyCacheEntry entry[DES_KEY_CACHE_SIZE];
+} DESKeyCache;
+
 // This is the Globals struct that we use throughout our library.
 typedef struct tagDESGlobalsType
 {
@@ -42,6 +97,9 @@ typedef struct tagDESGlobalsType
 	/////
 	// Your globals go here...
 	/////
+	int			probedKernel[DES_CLASSES];	// DES_KERNEL_* picked for the processor at DESOpen
+	int			forcedKernel[DES_CLASSES];	// DESSetKernel override, DES_KERNEL_AUTO for none
+	DESKeyCache	keyCache;				// recent key schedules, see DESKeyCache
 
 } DESGlobalsType;
 
@@ -59,7 +117,7 @@ Err					DESUnlockGlobals( DESGlobalsTypePtr gP );
 // *
 // *****
 
-void DES_Init(DES_CTX *, unsigned char *, unsigned char *, int);
+void DES_Init(DES_CTX *, unsigned char *, unsigned char *, int, DESKeyCache *);
 
 int DES_ECBUpdate(DES_CTX *, unsigned char *, unsigned char *, unsigned long);
 
@@ -71,9 +129,11 @@ int DES_OFBFIPS81Update(DES_CTX *, unsigned char *, unsigned char *, unsigned lo
 
 int DES_OFBISOUpdate(DES_CTX *, unsigned char *, unsigned char *, unsigned long);
 
+int DES_CTRUpdate(DES_CTX *, unsigned char *, unsigned char *, unsigned long);
+
 void DES_Restart(DES_CTX *);
 
-void DESX_Init(DES_CTX *, unsigned char *, unsigned char *, int);
+void DESX_Init(DES_CTX *, unsigned char *, unsigned char *, int, DESKeyCache *);
 
 int DESX_ECBUpdate(DES_CTX *, unsigned char *, unsigned char *, unsigned long);
 
@@ -85,9 +145,11 @@ int DESX_OFBISOUpdate(DES_CTX *, unsigned char *, unsigned char *, unsigned long
 
 int DESX_OFBFIPS81Update(DES_CTX *, unsigned char *, unsigned char *, unsigned long);
 
+int DESX_CTRUpdate(DES_CTX *, unsigned char *, unsigned char *, unsigned long);
+
 void DESX_Restart(DES_CTX *);
 
-void DES3_Init(DES_CTX *, unsigned char *, unsigned char *, int);
+void DES3_Init(DES_CTX *, unsigned char *, unsigned char *, int, DESKeyCache *);
 
 int DES3_ECBUpdate(DES_CTX *, unsigned char *, unsigned char *, unsigned long);
 
@@ -99,11 +161,54 @@ int DES3_OFBFIPS81Update(DES_CTX *, unsigned char *, unsigned char *, unsigned l
 
 int DES3_OFBISOUpdate(DES_CTX *, unsigned char *, unsigned char *, unsigned long);
 
+int DES3_CTRUpdate(DES_CTX *, unsigned char *, unsigned char *, unsigned long);
+
 void DES3_Restart(DES_CTX *);
 
 int Initialize_DES(unsigned char * keystring, unsigned char * iv, int desmode, int destype, int encrypt, DES_CTX * key);
 
+int Initialize_DESOptions(unsigned char * keystring, unsigned char * iv, int desmode, int destype, int encrypt, int options, DES_CTX * key);
+
+int Initialize_DESCached(unsigned char * keystring, unsigned char * iv, int desmode, int destype, int encrypt, int options, DES_CTX * key, DESKeyCache * cache);
+
+int Initialize_DESBatch(unsigned char * keys, unsigned char * ivs, int desmode, int destype, int encrypt, DES_CTX * contexts, unsigned long count);
+
+int SetIV_DES(DES_CTX *, unsigned char *);
+
+int Rekey_DES(DES_CTX *, unsigned char *, DESKeyCache *);
+
+int SetMode_DES(DES_CTX *, int);
+
+int SetSegment_DES(DES_CTX *, int);
+
+int SetLookahead_DES(DES_CTX *, unsigned char *, unsigned long);
+
+int FillLookahead_DES(DES_CTX *, unsigned long, unsigned long *);
+
+int SetCounter_DES(DES_CTX *, int);
+
+int Seek_DES(DES_CTX *, unsigned long);
+
 int Encrypt_DES(DES_CTX *, unsigned char *, unsigned char *, unsigned long);
 
 int Decrypt_DES(DES_CTX *, unsigned char *, unsigned char *, unsigned long);
 
+int DESKernelValid(int, int);
+
+void DESKeyCacheInit(DESKeyCache *, UInt32);
+
+void DESKeyCacheFlush(DESKeyCache *);
+
+#ifdef DES_CXX_CORE
+// Cipher core in DESCore.cpp, used by DESLibPrv.c when built with
+// DES_CXX_CORE.
+#ifdef __cplusplus
+extern "C" {
+#endif
+void DESKeyCxx(UInt32 *, unsigned char *, int);
+void DESFunctionCxx(UInt32 *, UInt32 *);
+void DES3FunctionCxx(UInt32 *, UInt32 (*)[32]);
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,421 @@
+// *****
+// * PROJECT:		DESLib (DES)
+// * FILENAME: 		DESTables.h
+// * AUTHOR:		Hector Ho Fuentes
+// *
+// * DESCRIPTION:	Read-only permutation and S-box tables shared by DESKey and
+// *				DESFunction in DESLibPrv.c and by the RSAREF copy in desc.c.
+// *				Include this from exactly the files that run the cipher; each
+// *				gets its own 2.5 KB of constant data, never a stack copy.
+// *
+// *				Set DES_TABLE_WORD before including if the caller's 32-bit
+// *				type is not UInt32 (desc.c uses RSAREF's UINT4).  Define
+// *				DES_COMPACT_TABLES for packed S-boxes in place of SP1..SP8,
+// *				and DES_KEY_TABLES for the 2 KB KEY_PC2 key-schedule tables.
+// *
+// * HISTORY:		Hector Ho Fuentes 4/4/2001
+// *
+// *
+// * COPYRIGHT:		
+// *
+// *****
+
+#ifndef _DESTABLES_H_
+#define _DESTABLES_H_ 1
+
+#ifndef DES_TABLE_WORD
+#define DES_TABLE_WORD UInt32
+#endif
+
+// The SP tables are 8 x 256 bytes; aligning each on a cache line keeps the
+// whole set in 32 lines on hosts that have a data cache at all.
+#if defined(__GNUC__)
+#define DES_TABLE_ALIGN __attribute__ ((aligned (64)))
+#else
+#define DES_TABLE_ALIGN
+#endif
+
+// A shared library has no A5 world, so constant data must be reached
+// PC-relative from the code resource instead of through the globals.
+#ifdef __MWERKS__
+#pragma pcrelconstdata on
+#endif
+
+static const unsigned short BYTE_BIT[8] = {
+  0200, 0100, 040, 020, 010, 04, 02, 01
+};
+
+static const DES_TABLE_WORD BIG_BYTE[24] = {
+  0x800000L, 0x400000L, 0x200000L, 0x100000L,
+  0x80000L,  0x40000L,  0x20000L,  0x10000L,
+  0x8000L,   0x4000L,   0x2000L,   0x1000L,
+  0x800L,    0x400L,    0x200L,    0x100L,
+  0x80L,     0x40L,     0x20L,     0x10L,
+  0x8L,      0x4L,      0x2L,      0x1L
+};
+
+static const unsigned char PC1[56] = {
+  56, 48, 40, 32, 24, 16,  8,      0, 57, 49, 41, 33, 25, 17,
+   9,  1, 58, 50, 42, 34, 26,     18, 10,  2, 59, 51, 43, 35,
+  62, 54, 46, 38, 30, 22, 14,      6, 61, 53, 45, 37, 29, 21,
+  13,  5, 60, 52, 44, 36, 28,     20, 12,  4, 27, 19, 11,  3
+};
+
+static const unsigned char TOTAL_ROTATIONS[16] = {
+  1, 2, 4, 6, 8, 10, 12, 14, 15, 17, 19, 21, 23, 25, 27, 28
+};
+
+static const unsigned char PC2[48] = {
+  13, 16, 10, 23,  0,  4,  2, 27, 14,  5, 20,  9,
+  22, 18, 11,  3, 25,  7, 15,  6, 26, 19, 12,  1,
+  40, 51, 30, 36, 46, 54, 29, 39, 50, 44, 32, 47,
+  43, 48, 38, 55, 33, 52, 45, 41, 49, 35, 28, 31
+};
+
+#ifdef DES_KEY_TABLES
+
+// PC2 for the word-wide key schedule: table k takes six of the 24 bits
+// PC2 keeps from one rotated half (0-3 the C half, 4-7 the D half) and
+// gives their positions in both cooked subkey words, the first word's
+// bits in place and the second's in the other 16-bit half.
+static const DES_TABLE_WORD KEY_PC2[8][64] = {
+  {
+    0x00000000L, 0x02000000L, 0x00000001L, 0x02000001L,
+    0x00002000L, 0x02002000L, 0x00002001L, 0x02002001L,
+    0x00040000L, 0x02040000L, 0x00040001L, 0x02040001L,
+    0x00042000L, 0x02042000L, 0x00042001L, 0x02042001L,
+    0x01000000L, 0x03000000L, 0x01000001L, 0x03000001L,
+    0x01002000L, 0x03002000L, 0x01002001L, 0x03002001L,
+    0x01040000L, 0x03040000L, 0x01040001L, 0x03040001L,
+    0x01042000L, 0x03042000L, 0x01042001L, 0x03042001L,
+    0x00000400L, 0x02000400L, 0x00000401L, 0x02000401L,
+    0x00002400L, 0x02002400L, 0x00002401L, 0x02002401L,
+    0x00040400L, 0x02040400L, 0x00040401L, 0x02040401L,
+    0x00042400L, 0x02042400L, 0x00042401L, 0x02042401L,
+    0x01000400L, 0x03000400L, 0x01000401L, 0x03000401L,
+    0x01002400L, 0x03002400L, 0x01002401L, 0x03002401L,
+    0x01040400L, 0x03040400L, 0x01040401L, 0x03040401L,
+    0x01042400L, 0x03042400L, 0x01042401L, 0x03042401L
+  },
+  {
+    0x00000000L, 0x00000010L, 0x00010000L, 0x00010010L,
+    0x00000100L, 0x00000110L, 0x00010100L, 0x00010110L,
+    0x08000000L, 0x08000010L, 0x08010000L, 0x08010010L,
+    0x08000100L, 0x08000110L, 0x08010100L, 0x08010110L,
+    0x00080000L, 0x00080010L, 0x00090000L, 0x00090010L,
+    0x00080100L, 0x00080110L, 0x00090100L, 0x00090110L,
+    0x08080000L, 0x08080010L, 0x08090000L, 0x08090010L,
+    0x08080100L, 0x08080110L, 0x08090100L, 0x08090110L,
+    0x00000002L, 0x00000012L, 0x00010002L, 0x00010012L,
+    0x00000102L, 0x00000112L, 0x00010102L, 0x00010112L,
+    0x08000002L, 0x08000012L, 0x08010002L, 0x08010012L,
+    0x08000102L, 0x08000112L, 0x08010102L, 0x08010112L,
+    0x00080002L, 0x00080012L, 0x00090002L, 0x00090012L,
+    0x00080102L, 0x00080112L, 0x00090102L, 0x00090112L,
+    0x08080002L, 0x08080012L, 0x08090002L, 0x08090012L,
+    0x08080102L, 0x08080112L, 0x08090102L, 0x08090112L
+  },
+  {
+    0x00000000L, 0x20000000L, 0x00000800L, 0x20000800L,
+    0x00000020L, 0x20000020L, 0x00000820L, 0x20000820L,
+    0x10000000L, 0x30000000L, 0x10000800L, 0x30000800L,
+    0x10000020L, 0x30000020L, 0x10000820L, 0x30000820L,
+    0x00100000L, 0x20100000L, 0x00100800L, 0x20100800L,
+    0x00100020L, 0x20100020L, 0x00100820L, 0x20100820L,
+    0x10100000L, 0x30100000L, 0x10100800L, 0x30100800L,
+    0x10100020L, 0x30100020L, 0x10100820L, 0x30100820L,
+    0x00000004L, 0x20000004L, 0x00000804L, 0x20000804L,
+    0x00000024L, 0x20000024L, 0x00000824L, 0x20000824L,
+    0x10000004L, 0x30000004L, 0x10000804L, 0x30000804L,
+    0x10000024L, 0x30000024L, 0x10000824L, 0x30000824L,
+    0x00100004L, 0x20100004L, 0x00100804L, 0x20100804L,
+    0x00100024L, 0x20100024L, 0x00100824L, 0x20100824L,
+    0x10100004L, 0x30100004L, 0x10100804L, 0x30100804L,
+    0x10100024L, 0x30100024L, 0x10100824L, 0x30100824L
+  },
+  {
+    0x00000000L, 0x00000200L, 0x00200000L, 0x00200200L,
+    0x04000000L, 0x04000200L, 0x04200000L, 0x04200200L,
+    0x00020000L, 0x00020200L, 0x00220000L, 0x00220200L,
+    0x04020000L, 0x04020200L, 0x04220000L, 0x04220200L,
+    0x00000008L, 0x00000208L, 0x00200008L, 0x00200208L,
+    0x04000008L, 0x04000208L, 0x04200008L, 0x04200208L,
+    0x00020008L, 0x00020208L, 0x00220008L, 0x00220208L,
+    0x04020008L, 0x04020208L, 0x04220008L, 0x04220208L,
+    0x00001000L, 0x00001200L, 0x00201000L, 0x00201200L,
+    0x04001000L, 0x04001200L, 0x04201000L, 0x04201200L,
+    0x00021000L, 0x00021200L, 0x00221000L, 0x00221200L,
+    0x04021000L, 0x04021200L, 0x04221000L, 0x04221200L,
+    0x00001008L, 0x00001208L, 0x00201008L, 0x00201208L,
+    0x04001008L, 0x04001208L, 0x04201008L, 0x04201208L,
+    0x00021008L, 0x00021208L, 0x00221008L, 0x00221208L,
+    0x04021008L, 0x04021208L, 0x04221008L, 0x04221208L
+  },
+  {
+    0x00000000L, 0x00020000L, 0x20000000L, 0x20020000L,
+    0x00000800L, 0x00020800L, 0x20000800L, 0x20020800L,
+    0x00010000L, 0x00030000L, 0x20010000L, 0x20030000L,
+    0x00010800L, 0x00030800L, 0x20010800L, 0x20030800L,
+    0x02000000L, 0x02020000L, 0x22000000L, 0x22020000L,
+    0x02000800L, 0x02020800L, 0x22000800L, 0x22020800L,
+    0x02010000L, 0x02030000L, 0x22010000L, 0x22030000L,
+    0x02010800L, 0x02030800L, 0x22010800L, 0x22030800L,
+    0x00000002L, 0x00020002L, 0x20000002L, 0x20020002L,
+    0x00000802L, 0x00020802L, 0x20000802L, 0x20020802L,
+    0x00010002L, 0x00030002L, 0x20010002L, 0x20030002L,
+    0x00010802L, 0x00030802L, 0x20010802L, 0x20030802L,
+    0x02000002L, 0x02020002L, 0x22000002L, 0x22020002L,
+    0x02000802L, 0x02020802L, 0x22000802L, 0x22020802L,
+    0x02010002L, 0x02030002L, 0x22010002L, 0x22030002L,
+    0x02010802L, 0x02030802L, 0x22010802L, 0x22030802L
+  },
+  {
+    0x00000000L, 0x00040000L, 0x00000400L, 0x00040400L,
+    0x00000008L, 0x00040008L, 0x00000408L, 0x00040408L,
+    0x10000000L, 0x10040000L, 0x10000400L, 0x10040400L,
+    0x10000008L, 0x10040008L, 0x10000408L, 0x10040408L,
+    0x00002000L, 0x00042000L, 0x00002400L, 0x00042400L,
+    0x00002008L, 0x00042008L, 0x00002408L, 0x00042408L,
+    0x10002000L, 0x10042000L, 0x10002400L, 0x10042400L,
+    0x10002008L, 0x10042008L, 0x10002408L, 0x10042408L,
+    0x00100000L, 0x00140000L, 0x00100400L, 0x00140400L,
+    0x00100008L, 0x00140008L, 0x00100408L, 0x00140408L,
+    0x10100000L, 0x10140000L, 0x10100400L, 0x10140400L,
+    0x10100008L, 0x10140008L, 0x10100408L, 0x10140408L,
+    0x00102000L, 0x00142000L, 0x00102400L, 0x00142400L,
+    0x00102008L, 0x00142008L, 0x00102408L, 0x00142408L,
+    0x10102000L, 0x10142000L, 0x10102400L, 0x10142400L,
+    0x10102008L, 0x10142008L, 0x10102408L, 0x10142408L
+  },
+  {
+    0x00000000L, 0x00000020L, 0x04000000L, 0x04000020L,
+    0x00200000L, 0x00200020L, 0x04200000L, 0x04200020L,
+    0x00000200L, 0x00000220L, 0x04000200L, 0x04000220L,
+    0x00200200L, 0x00200220L, 0x04200200L, 0x04200220L,
+    0x01000000L, 0x01000020L, 0x05000000L, 0x05000020L,
+    0x01200000L, 0x01200020L, 0x05200000L, 0x05200020L,
+    0x01000200L, 0x01000220L, 0x05000200L, 0x05000220L,
+    0x01200200L, 0x01200220L, 0x05200200L, 0x05200220L,
+    0x00000010L, 0x00000030L, 0x04000010L, 0x04000030L,
+    0x00200010L, 0x00200030L, 0x04200010L, 0x04200030L,
+    0x00000210L, 0x00000230L, 0x04000210L, 0x04000230L,
+    0x00200210L, 0x00200230L, 0x04200210L, 0x04200230L,
+    0x01000010L, 0x01000030L, 0x05000010L, 0x05000030L,
+    0x01200010L, 0x01200030L, 0x05200010L, 0x05200030L,
+    0x01000210L, 0x01000230L, 0x05000210L, 0x05000230L,
+    0x01200210L, 0x01200230L, 0x05200210L, 0x05200230L
+  },
+  {
+    0x00000000L, 0x00080000L, 0x08000000L, 0x08080000L,
+    0x00001000L, 0x00081000L, 0x08001000L, 0x08081000L,
+    0x00000001L, 0x00080001L, 0x08000001L, 0x08080001L,
+    0x00001001L, 0x00081001L, 0x08001001L, 0x08081001L,
+    0x00000100L, 0x00080100L, 0x08000100L, 0x08080100L,
+    0x00001100L, 0x00081100L, 0x08001100L, 0x08081100L,
+    0x00000101L, 0x00080101L, 0x08000101L, 0x08080101L,
+    0x00001101L, 0x00081101L, 0x08001101L, 0x08081101L,
+    0x00000004L, 0x00080004L, 0x08000004L, 0x08080004L,
+    0x00001004L, 0x00081004L, 0x08001004L, 0x08081004L,
+    0x00000005L, 0x00080005L, 0x08000005L, 0x08080005L,
+    0x00001005L, 0x00081005L, 0x08001005L, 0x08081005L,
+    0x00000104L, 0x00080104L, 0x08000104L, 0x08080104L,
+    0x00001104L, 0x00081104L, 0x08001104L, 0x08081104L,
+    0x00000105L, 0x00080105L, 0x08000105L, 0x08080105L,
+    0x00001105L, 0x00081105L, 0x08001105L, 0x08081105L
+  }
+};
+
+#endif
+
+#ifdef DES_COMPACT_TABLES
+
+// Compact form for small builds: the eight S-boxes packed two 4-bit
+// entries per byte, indexed by the 6-bit input as it is cut from the
+// round's work word (entry j in the high nibble when j is even), and the
+// bit each S-box output bit lands on after P and the one-bit rotation
+// of the round halves.  256 + 32 bytes instead of the 2 KB of SP tables.
+static const unsigned char SBOX[8][32] = {
+  { 0xe0, 0x4f, 0xd7, 0x14, 0x2e, 0xf2, 0xbd, 0x81, 0x3a, 0xa6, 0x6c, 0xcb, 0x59, 0x95, 0x03, 0x78,
+    0x4f, 0x1c, 0xe8, 0x82, 0xd4, 0x69, 0x21, 0xb7, 0xf5, 0xcb, 0x93, 0x7e, 0x3a, 0xa0, 0x56, 0x0d },
+  { 0xf3, 0x1d, 0x84, 0xe7, 0x6f, 0xb2, 0x38, 0x4e, 0x9c, 0x70, 0x21, 0xda, 0xc6, 0x09, 0x5b, 0xa5,
+    0x0d, 0xe8, 0x7a, 0xb1, 0xa3, 0x4f, 0xd4, 0x12, 0x5b, 0x86, 0xc7, 0x6c, 0x90, 0x35, 0x2e, 0xf9 },
+  { 0xad, 0x07, 0x90, 0xe9, 0x63, 0x34, 0xf6, 0x5a, 0x12, 0xd8, 0xc5, 0x7e, 0xbc, 0x4b, 0x2f, 0x81,
+    0xd1, 0x6a, 0x4d, 0x90, 0x86, 0xf9, 0x38, 0x07, 0xb4, 0x1f, 0x2e, 0xc3, 0x5b, 0xa5, 0xe2, 0x7c },
+  { 0x7d, 0xd8, 0xeb, 0x35, 0x06, 0x6f, 0x90, 0xa3, 0x14, 0x27, 0x82, 0x5c, 0xb1, 0xca, 0x4e, 0xf9,
+    0xa3, 0x6f, 0x90, 0x06, 0xca, 0xb1, 0x7d, 0xd8, 0xf9, 0x14, 0x35, 0xeb, 0x5c, 0x27, 0x82, 0x4e },
+  { 0x2e, 0xcb, 0x42, 0x1c, 0x74, 0xa7, 0xbd, 0x61, 0x85, 0x50, 0x3f, 0xfa, 0xd3, 0x09, 0xe8, 0x96,
+    0x4b, 0x28, 0x1c, 0xb7, 0xa1, 0xde, 0x72, 0x8d, 0xf6, 0x9f, 0xc0, 0x59, 0x6a, 0x34, 0x05, 0xe3 },
+  { 0xca, 0x1f, 0xa4, 0xf2, 0x97, 0x2c, 0x69, 0x85, 0x06, 0xd1, 0x3d, 0x4e, 0xe0, 0x7b, 0x53, 0xb8,
+    0x94, 0xe3, 0xf2, 0x5c, 0x29, 0x85, 0xcf, 0x3a, 0x7b, 0x0e, 0x41, 0xa7, 0x16, 0xd0, 0xb8, 0x6d },
+  { 0x4d, 0xb0, 0x2b, 0xe7, 0xf4, 0x09, 0x81, 0xda, 0x3e, 0xc3, 0x95, 0x7c, 0x52, 0xaf, 0x68, 0x16,
+    0x16, 0x4b, 0xbd, 0xd8, 0xc1, 0x34, 0x7a, 0xe7, 0xa9, 0xf5, 0x60, 0x8f, 0x0e, 0x52, 0x93, 0x2c },
+  { 0xd1, 0x2f, 0x8d, 0x48, 0x6a, 0xf3, 0xb7, 0x14, 0xac, 0x95, 0x36, 0xeb, 0x50, 0x0e, 0xc9, 0x72,
+    0x72, 0xb1, 0x4e, 0x17, 0x94, 0xca, 0xe8, 0x2d, 0x0f, 0x6c, 0xa9, 0xd0, 0xf3, 0x35, 0x56, 0x8b }
+};
+
+static const unsigned char P_ROTATED[32] = {
+  12, 18,  6, 28, 26, 11, 21,  1, 14, 22,  4, 29, 30,  8, 19, 25,
+   0, 23, 13,  7, 27,  3, 17,  9, 15, 31,  5, 20,  2, 10, 16, 24
+};
+
+#else
+
+static const DES_TABLE_WORD SP1[64] DES_TABLE_ALIGN = {
+  0x01010400L, 0x00000000L, 0x00010000L, 0x01010404L,
+  0x01010004L, 0x00010404L, 0x00000004L, 0x00010000L,
+  0x00000400L, 0x01010400L, 0x01010404L, 0x00000400L,
+  0x01000404L, 0x01010004L, 0x01000000L, 0x00000004L,
+  0x00000404L, 0x01000400L, 0x01000400L, 0x00010400L,
+  0x00010400L, 0x01010000L, 0x01010000L, 0x01000404L,
+  0x00010004L, 0x01000004L, 0x01000004L, 0x00010004L,
+  0x00000000L, 0x00000404L, 0x00010404L, 0x01000000L,
+  0x00010000L, 0x01010404L, 0x00000004L, 0x01010000L,
+  0x01010400L, 0x01000000L, 0x01000000L, 0x00000400L,
+  0x01010004L, 0x00010000L, 0x00010400L, 0x01000004L,
+  0x00000400L, 0x00000004L, 0x01000404L, 0x00010404L,
+  0x01010404L, 0x00010004L, 0x01010000L, 0x01000404L,
+  0x01000004L, 0x00000404L, 0x00010404L, 0x01010400L,
+  0x00000404L, 0x01000400L, 0x01000400L, 0x00000000L,
+  0x00010004L, 0x00010400L, 0x00000000L, 0x01010004L
+};
+
+static const DES_TABLE_WORD SP2[64] DES_TABLE_ALIGN = {
+  0x80108020L, 0x80008000L, 0x00008000L, 0x00108020L,
+  0x00100000L, 0x00000020L, 0x80100020L, 0x80008020L,
+  0x80000020L, 0x80108020L, 0x80108000L, 0x80000000L,
+  0x80008000L, 0x00100000L, 0x00000020L, 0x80100020L,
+  0x00108000L, 0x00100020L, 0x80008020L, 0x00000000L,
+  0x80000000L, 0x00008000L, 0x00108020L, 0x80100000L,
+  0x00100020L, 0x80000020L, 0x00000000L, 0x00108000L,
+  0x00008020L, 0x80108000L, 0x80100000L, 0x00008020L,
+  0x00000000L, 0x00108020L, 0x80100020L, 0x00100000L,
+  0x80008020L, 0x80100000L, 0x80108000L, 0x00008000L,
+  0x80100000L, 0x80008000L, 0x00000020L, 0x80108020L,
+  0x00108020L, 0x00000020L, 0x00008000L, 0x80000000L,
+  0x00008020L, 0x80108000L, 0x00100000L, 0x80000020L,
+  0x00100020L, 0x80008020L, 0x80000020L, 0x00100020L,
+  0x00108000L, 0x00000000L, 0x80008000L, 0x00008020L,
+  0x80000000L, 0x80100020L, 0x80108020L, 0x00108000L
+};
+
+static const DES_TABLE_WORD SP3[64] DES_TABLE_ALIGN = {
+  0x00000208L, 0x08020200L, 0x00000000L, 0x08020008L,
+  0x08000200L, 0x00000000L, 0x00020208L, 0x08000200L,
+  0x00020008L, 0x08000008L, 0x08000008L, 0x00020000L,
+  0x08020208L, 0x00020008L, 0x08020000L, 0x00000208L,
+  0x08000000L, 0x00000008L, 0x08020200L, 0x00000200L,
+  0x00020200L, 0x08020000L, 0x08020008L, 0x00020208L,
+  0x08000208L, 0x00020200L, 0x00020000L, 0x08000208L,
+  0x00000008L, 0x08020208L, 0x00000200L, 0x08000000L,
+  0x08020200L, 0x08000000L, 0x00020008L, 0x00000208L,
+  0x00020000L, 0x08020200L, 0x08000200L, 0x00000000L,
+  0x00000200L, 0x00020008L, 0x08020208L, 0x08000200L,
+  0x08000008L, 0x00000200L, 0x00000000L, 0x08020008L,
+  0x08000208L, 0x00020000L, 0x08000000L, 0x08020208L,
+  0x00000008L, 0x00020208L, 0x00020200L, 0x08000008L,
+  0x08020000L, 0x08000208L, 0x00000208L, 0x08020000L,
+  0x00020208L, 0x00000008L, 0x08020008L, 0x00020200L
+};
+
+static const DES_TABLE_WORD SP4[64] DES_TABLE_ALIGN = {
+  0x00802001L, 0x00002081L, 0x00002081L, 0x00000080L,
+  0x00802080L, 0x00800081L, 0x00800001L, 0x00002001L,
+  0x00000000L, 0x00802000L, 0x00802000L, 0x00802081L,
+  0x00000081L, 0x00000000L, 0x00800080L, 0x00800001L,
+  0x00000001L, 0x00002000L, 0x00800000L, 0x00802001L,
+  0x00000080L, 0x00800000L, 0x00002001L, 0x00002080L,
+  0x00800081L, 0x00000001L, 0x00002080L, 0x00800080L,
+  0x00002000L, 0x00802080L, 0x00802081L, 0x00000081L,
+  0x00800080L, 0x00800001L, 0x00802000L, 0x00802081L,
+  0x00000081L, 0x00000000L, 0x00000000L, 0x00802000L,
+  0x00002080L, 0x00800080L, 0x00800081L, 0x00000001L,
+  0x00802001L, 0x00002081L, 0x00002081L, 0x00000080L,
+  0x00802081L, 0x00000081L, 0x00000001L, 0x00002000L,
+  0x00800001L, 0x00002001L, 0x00802080L, 0x00800081L,
+  0x00002001L, 0x00002080L, 0x00800000L, 0x00802001L,
+  0x00000080L, 0x00800000L, 0x00002000L, 0x00802080L
+};
+
+static const DES_TABLE_WORD SP5[64] DES_TABLE_ALIGN = {
+  0x00000100L, 0x02080100L, 0x02080000L, 0x42000100L,
+  0x00080000L, 0x00000100L, 0x40000000L, 0x02080000L,
+  0x40080100L, 0x00080000L, 0x02000100L, 0x40080100L,
+  0x42000100L, 0x42080000L, 0x00080100L, 0x40000000L,
+  0x02000000L, 0x40080000L, 0x40080000L, 0x00000000L,
+  0x40000100L, 0x42080100L, 0x42080100L, 0x02000100L,
+  0x42080000L, 0x40000100L, 0x00000000L, 0x42000000L,
+  0x02080100L, 0x02000000L, 0x42000000L, 0x00080100L,
+  0x00080000L, 0x42000100L, 0x00000100L, 0x02000000L,
+  0x40000000L, 0x02080000L, 0x42000100L, 0x40080100L,
+  0x02000100L, 0x40000000L, 0x42080000L, 0x02080100L,
+  0x40080100L, 0x00000100L, 0x02000000L, 0x42080000L,
+  0x42080100L, 0x00080100L, 0x42000000L, 0x42080100L,
+  0x02080000L, 0x00000000L, 0x40080000L, 0x42000000L,
+  0x00080100L, 0x02000100L, 0x40000100L, 0x00080000L,
+  0x00000000L, 0x40080000L, 0x02080100L, 0x40000100L
+};
+
+static const DES_TABLE_WORD SP6[64] DES_TABLE_ALIGN = {
+  0x20000010L, 0x20400000L, 0x00004000L, 0x20404010L,
+  0x20400000L, 0x00000010L, 0x20404010L, 0x00400000L,
+  0x20004000L, 0x00404010L, 0x00400000L, 0x20000010L,
+  0x00400010L, 0x20004000L, 0x20000000L, 0x00004010L,
+  0x00000000L, 0x00400010L, 0x20004010L, 0x00004000L,
+  0x00404000L, 0x20004010L, 0x00000010L, 0x20400010L,
+  0x20400010L, 0x00000000L, 0x00404010L, 0x20404000L,
+  0x00004010L, 0x00404000L, 0x20404000L, 0x20000000L,
+  0x20004000L, 0x00000010L, 0x20400010L, 0x00404000L,
+  0x20404010L, 0x00400000L, 0x00004010L, 0x20000010L,
+  0x00400000L, 0x20004000L, 0x20000000L, 0x00004010L,
+  0x20000010L, 0x20404010L, 0x00404000L, 0x20400000L,
+  0x00404010L, 0x20404000L, 0x00000000L, 0x20400010L,
+  0x00000010L, 0x00004000L, 0x20400000L, 0x00404010L,
+  0x00004000L, 0x00400010L, 0x20004010L, 0x00000000L,
+  0x20404000L, 0x20000000L, 0x00400010L, 0x20004010L
+};
+
+static const DES_TABLE_WORD SP7[64] DES_TABLE_ALIGN = {
+  0x00200000L, 0x04200002L, 0x04000802L, 0x00000000L,
+  0x00000800L, 0x04000802L, 0x00200802L, 0x04200800L,
+  0x04200802L, 0x00200000L, 0x00000000L, 0x04000002L,
+  0x00000002L, 0x04000000L, 0x04200002L, 0x00000802L,
+  0x04000800L, 0x00200802L, 0x00200002L, 0x04000800L,
+  0x04000002L, 0x04200000L, 0x04200800L, 0x00200002L,
+  0x04200000L, 0x00000800L, 0x00000802L, 0x04200802L,
+  0x00200800L, 0x00000002L, 0x04000000L, 0x00200800L,
+  0x04000000L, 0x00200800L, 0x00200000L, 0x04000802L,
+  0x04000802L, 0x04200002L, 0x04200002L, 0x00000002L,
+  0x00200002L, 0x04000000L, 0x04000800L, 0x00200000L,
+  0x04200800L, 0x00000802L, 0x00200802L, 0x04200800L,
+  0x00000802L, 0x04000002L, 0x04200802L, 0x04200000L,
+  0x00200800L, 0x00000000L, 0x00000002L, 0x04200802L,
+  0x00000000L, 0x00200802L, 0x04200000L, 0x00000800L,
+  0x04000002L, 0x04000800L, 0x00000800L, 0x00200002L
+};
+
+static const DES_TABLE_WORD SP8[64] DES_TABLE_ALIGN = {
+  0x10001040L, 0x00001000L, 0x00040000L, 0x10041040L,
+  0x10000000L, 0x10001040L, 0x00000040L, 0x10000000L,
+  0x00040040L, 0x10040000L, 0x10041040L, 0x00041000L,
+  0x10041000L, 0x00041040L, 0x00001000L, 0x00000040L,
+  0x10040000L, 0x10000040L, 0x10001000L, 0x00001040L,
+  0x00041000L, 0x00040040L, 0x10040040L, 0x10041000L,
+  0x00001040L, 0x00000000L, 0x00000000L, 0x10040040L,
+  0x10000040L, 0x10001000L, 0x00041040L, 0x00040000L,
+  0x00041040L, 0x00040000L, 0x10041000L, 0x00001000L,
+  0x00000040L, 0x10040040L, 0x00001000L, 0x00041040L,
+  0x10001000L, 0x00000040L, 0x10000040L, 0x10040000L,
+  0x10040040L, 0x10000000L, 0x00040000L, 0x10001040L,
+  0x00000000L, 0x10041040L, 0x00040040L, 0x10000040L,
+  0x10040000L, 0x10001000L, 0x10001040L, 0x00000000L,
+  0x10041040L, 0x00041000L, 0x00041000L, 0x00001040L,
+  0x00001040L, 0x00040040L, 0x10000000L, 0x10041000L
+};
+
+#endif
+
+#ifdef __MWERKS__
+#pragma pcrelconstdata reset
+#endif
+
+#endif